@@ -6,4 +6,7 @@
 #include "common/Acceleration/AccelerationNode.h"
 #include "common/Acceleration/Naive/NaiveAcceleration.h"
 #include "common/Acceleration/BVH/BVHAcceleration.h"
-#include "common/Acceleration/UniformGrid/UniformGridAcceleration.h"
\ No newline at end of file
+#include "common/Acceleration/UniformGrid/UniformGridAcceleration.h"
+#include "common/Acceleration/WideBVH/WideBVHAcceleration.h"
+#include "common/Acceleration/HierarchicalGrid/HierarchicalGridAcceleration.h"
+#include "common/Acceleration/KDTree/KDTreeAcceleration.h"
\ No newline at end of file
@@ -13,9 +13,18 @@ namespace AccelerationGenerator
             case AccelerationTypes::BVH:
                 acceleration = make_unique<BVHAcceleration>();
                 break;
+            case AccelerationTypes::BVH_WIDE:
+                acceleration = make_unique<WideBVHAcceleration>();
+                break;
             case AccelerationTypes::UNIFORM_GRID:
                 acceleration = make_unique<UniformGridAcceleration>();
                 break;
+            case AccelerationTypes::HIERARCHICAL_GRID:
+                acceleration = make_unique<HierarchicalGridAcceleration>();
+                break;
+            case AccelerationTypes::KDTREE:
+                acceleration = make_unique<KDTreeAcceleration>();
+                break;
             default:
                 throw std::runtime_error("ERROR: Unsupported acceleration structure.");
                 break;
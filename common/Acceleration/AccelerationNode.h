@@ -12,6 +12,8 @@ public:
 
     virtual Box GetBoundingBox() const = 0;
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const = 0;
+    // Returns true as soon as anything is hit before the maximum t of the ray; which hit is found does not matter.
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const { return Trace(parentObject, inputRay, nullptr); }
     virtual uint64_t GetUniqueId() const { return uniqueId; }
     virtual std::string GetHumanIdentifier() const { return ""; }
 private:
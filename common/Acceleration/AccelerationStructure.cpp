@@ -1,7 +1,8 @@
 #include "common/Acceleration/AccelerationStructure.h"
 #include "common/Scene/SceneObject.h"
 
-AccelerationStructure::AccelerationStructure()
+AccelerationStructure::AccelerationStructure():
+    initialized(false)
 {
 }
 
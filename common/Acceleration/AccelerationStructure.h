@@ -19,12 +19,20 @@ public:
         }
 
         InternalInitialization();
+        initialized = true;
     }
 
+    // Structures shared between instances are only built by the first one that gets finalized.
+    bool IsInitialized() const { return initialized; }
+
     virtual bool Trace(const class SceneObject* sceneObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const = 0;
+    // Any-hit query, stops at the first node that reports a hit.
+    virtual bool Occluded(const class SceneObject* sceneObject, class Ray* inputRay) const = 0;
 protected:
     std::vector<std::shared_ptr<AccelerationNode>> nodes;
 
 private:
     virtual void InternalInitialization() {}
+
+    bool initialized;
 };
\ No newline at end of file
@@ -4,5 +4,8 @@ enum class AccelerationTypes
 {
     NONE,
     UNIFORM_GRID,
-    BVH
+    BVH,
+    BVH_WIDE,
+    HIERARCHICAL_GRID,
+    KDTREE
 };
\ No newline at end of file
@@ -1,16 +1,203 @@
 #include "common/Acceleration/BVH/BVHAcceleration.h"
-#include "common/Acceleration/BVH/Internal/BVHNode.h"
+#include "common/Acceleration/BVH/Internal/BVHBuilder.h"
+#include "common/Scene/Geometry/Simple/Box/BoxPacket.h"
+#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+#include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 #include "common/Intersection/IntersectionState.h"
 
+namespace
+{
+    const int LOCAL_STACK_SIZE = 64;
+}
+
 BVHAcceleration::BVHAcceleration():
-    maximumChildren(2), nodesOnLeaves(2)
+    maximumChildren(2), nodesOnLeaves(2), splitMethod(BVHSplitMethod::SAH), traversalCost(0.125f), intersectionCost(1.f), traversalStackSize(1), triangleKernel(TriangleKernel::AUTO)
 {
 }
 
 bool BVHAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
 {
-    return rootNode->Trace(parentObject, inputRay, outputIntersection);
+    if (!outputIntersection) {
+        return Occluded(parentObject, inputRay);
+    }
+    if (flatNodes.empty()) {
+        return false;
+    }
+
+    // Convert the ray into the space of the BVH once instead of once per box.
+    const BoxRay boxRay = TransformRay(parentObject, inputRay);
+
+    // The root box is tested up front; every other box is tested by its parent so the children can be ordered.
+    const float rayMaxT = inputRay->GetMaxT();
+    float entryT = 0.f;
+    if (!flatNodes[0].boundingBox.Trace(boxRay, rayMaxT, entryT)) {
+        return false;
+    }
+
+    TraversalEntry localStack[LOCAL_STACK_SIZE];
+    std::vector<TraversalEntry> overflowStack;
+    TraversalEntry* nodeStack = localStack;
+    if (traversalStackSize > LOCAL_STACK_SIZE) {
+        overflowStack.resize(traversalStackSize);
+        nodeStack = overflowStack.data();
+    }
+
+    int stackSize = 0;
+    nodeStack[stackSize++] = TraversalEntry{ 0, entryT };
+
+    bool hitObject = false;
+    while (stackSize > 0) {
+        const TraversalEntry entry = nodeStack[--stackSize];
+        const float maxT = std::min(rayMaxT, outputIntersection->intersectionT);
+
+        // A closer hit may have been found since this node was pushed.
+        if (entry.entryT - maxT > SMALL_EPSILON) {
+            continue;
+        }
+
+        const BVHNode& node = flatNodes[entry.nodeIndex];
+        if (node.isLeaf) {
+            if (leafPacketOffsets[node.offset] >= 0) {
+                hitObject |= TraceTrianglePackets(node.offset, node.count, parentObject, inputRay, outputIntersection);
+                continue;
+            }
+            for (int i = 0; i < node.count; ++i) {
+                hitObject |= packedPrimitives[node.offset + i]->Trace(parentObject, inputRay, outputIntersection);
+            }
+            continue;
+        }
+
+        const int firstChild = stackSize;
+        for (int i = 0; i < node.count; ++i) {
+            if (flatNodes[node.offset + i].boundingBox.Trace(boxRay, maxT, entryT)) {
+                nodeStack[stackSize++] = TraversalEntry{ node.offset + i, entryT };
+            }
+        }
+
+        // Far children go to the bottom so that the nearest one is visited first.
+        std::sort(nodeStack + firstChild, nodeStack + stackSize, [](const TraversalEntry& a, const TraversalEntry& b) {
+            return a.entryT > b.entryT;
+        });
+    }
+    return hitObject;
+}
+
+bool BVHAcceleration::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    if (flatNodes.empty()) {
+        return false;
+    }
+
+    const BoxRay boxRay = TransformRay(parentObject, inputRay);
+
+    int localStack[LOCAL_STACK_SIZE];
+    std::vector<int> overflowStack;
+    int* nodeStack = localStack;
+    if (traversalStackSize > LOCAL_STACK_SIZE) {
+        overflowStack.resize(traversalStackSize);
+        nodeStack = overflowStack.data();
+    }
+
+    int stackSize = 0;
+    nodeStack[stackSize++] = 0;
+
+    // Any hit ends the query, so the order in which the children are visited does not matter here.
+    const float maxT = inputRay->GetMaxT();
+    while (stackSize > 0) {
+        const BVHNode& node = flatNodes[nodeStack[--stackSize]];
+        float entryT;
+        if (!node.boundingBox.Trace(boxRay, maxT, entryT)) {
+            continue;
+        }
+
+        if (node.isLeaf) {
+            if (leafPacketOffsets[node.offset] >= 0) {
+                if (TraceTrianglePackets(node.offset, node.count, parentObject, inputRay, nullptr)) {
+                    return true;
+                }
+                continue;
+            }
+            for (int i = 0; i < node.count; ++i) {
+                if (packedPrimitives[node.offset + i]->Occluded(parentObject, inputRay)) {
+                    return true;
+                }
+            }
+        } else {
+            for (int i = node.count - 1; i >= 0; --i) {
+                nodeStack[stackSize++] = node.offset + i;
+            }
+        }
+    }
+    return false;
+}
+
+BoxRay BVHAcceleration::TransformRay(const SceneObject* parentObject, const Ray* inputRay) const
+{
+    glm::mat4 spaceTransform(1.f);
+    if (parentObject) {
+        spaceTransform = parentObject->GetWorldToObjectMatrix();
+    }
+    return BoxRay(glm::vec3(spaceTransform * inputRay->GetPosition()), glm::vec3(spaceTransform * inputRay->GetForwardDirection()));
+}
+
+bool BVHAcceleration::TraceTrianglePackets(int leafOffset, int leafCount, const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    assert(parentObject);
+    glm::vec3 rayPos, rayDir;
+    inputRay->GetObjectSpaceRay(parentObject, rayPos, rayDir);
+
+    const float rayMaxT = inputRay->GetMaxT();
+    const int firstPacket = leafPacketOffsets[leafOffset];
+    const int totalPackets = (leafCount + TrianglePacket::WIDTH - 1) / TrianglePacket::WIDTH;
+
+    bool hitObject = false;
+    float t[TrianglePacket::WIDTH], u[TrianglePacket::WIDTH], v[TrianglePacket::WIDTH];
+    for (int p = firstPacket; p < firstPacket + totalPackets; ++p) {
+        const TrianglePacket& packet = trianglePackets[p];
+        int hitMask = packet.Trace(triangleKernel, rayPos, rayDir, rayMaxT, t, u, v);
+        if (hitMask && !outputIntersection) {
+            return true;
+        }
+
+        // Accept the hits in lane order against the closest hit so far, just like testing them one by one would.
+        for (int lane = 0; hitMask; ++lane, hitMask >>= 1) {
+            if (!(hitMask & 1) || t[lane] - outputIntersection->intersectionT > SMALL_EPSILON) {
+                continue;
+            }
+            packet.triangles[lane]->StoreIntersection(parentObject, inputRay, t[lane], u[lane], v[lane], outputIntersection);
+            hitObject = true;
+        }
+    }
+    return hitObject;
+}
+
+void BVHAcceleration::BuildTrianglePackets()
+{
+    trianglePackets.clear();
+    leafPacketOffsets.assign(packedPrimitives.size(), -1);
+    for (size_t n = 0; n < flatNodes.size(); ++n) {
+        const BVHNode& node = flatNodes[n];
+        if (!node.isLeaf || node.count == 0) {
+            continue;
+        }
+
+        std::vector<const Triangle*> leafTriangles(node.count);
+        for (int i = 0; i < node.count; ++i) {
+            leafTriangles[i] = dynamic_cast<const Triangle*>(packedPrimitives[node.offset + i]);
+        }
+        if (std::find(leafTriangles.begin(), leafTriangles.end(), nullptr) != leafTriangles.end()) {
+            continue;
+        }
+
+        leafPacketOffsets[node.offset] = static_cast<int>(trianglePackets.size());
+        for (int i = 0; i < node.count; ++i) {
+            if (i % TrianglePacket::WIDTH == 0) {
+                trianglePackets.emplace_back();
+            }
+            trianglePackets.back().SetTriangle(i % TrianglePacket::WIDTH, leafTriangles[i]);
+        }
+    }
 }
 
 void BVHAcceleration::InternalInitialization()
@@ -24,7 +211,18 @@ void BVHAcceleration::InternalInitialization()
         maximumChildren = nodesOnLeaves;
     }
 
-    rootNode = std::make_shared<BVHNode>(nodes, maximumChildren, nodesOnLeaves);
+    BVHBuilder builder(maximumChildren, nodesOnLeaves, splitMethod, traversalCost, intersectionCost);
+    traversalStackSize = builder.Build(nodes, flatNodes, packedPrimitives);
+
+    if (triangleKernel != TriangleKernel::AUTO && !IsTriangleKernelSupported(triangleKernel)) {
+        std::cerr << "WARNING: The requested triangle kernel is not supported on this CPU. Using the best supported one." << std::endl;
+    }
+    triangleKernel = ResolveTriangleKernel(triangleKernel);
+    BuildTrianglePackets();
+
+#if !DISABLE_BVH_COST_REPORT
+    std::cout << "BVH with " << packedPrimitives.size() << " primitives and " << flatNodes.size() << " nodes, expected cost: " << GetExpectedCost() << std::endl;
+#endif
 }
 
 void BVHAcceleration::SetMaximumChildren(int input)
@@ -35,4 +233,29 @@ void BVHAcceleration::SetMaximumChildren(int input)
 void BVHAcceleration::SetNodesOnLeaves(int input)
 {
     nodesOnLeaves = input;
-}
\ No newline at end of file
+}
+
+void BVHAcceleration::SetSplitMethod(BVHSplitMethod input)
+{
+    splitMethod = input;
+}
+
+void BVHAcceleration::SetTraversalCost(float input)
+{
+    traversalCost = input;
+}
+
+void BVHAcceleration::SetIntersectionCost(float input)
+{
+    intersectionCost = input;
+}
+
+void BVHAcceleration::SetTriangleKernel(TriangleKernel input)
+{
+    triangleKernel = input;
+}
+
+float BVHAcceleration::GetExpectedCost() const
+{
+    return BVHBuilder::ComputeExpectedCost(flatNodes, traversalCost, intersectionCost);
+}
@@ -1,21 +1,63 @@
 #pragma once
 
 #include "common/Acceleration/AccelerationStructure.h"
+#include "common/Acceleration/BVH/BVHSplitMethod.h"
+#include "common/Acceleration/BVH/Internal/BVHNode.h"
+#include "common/Scene/Geometry/Primitives/Triangle/TrianglePacket.h"
 
 class BVHAcceleration : public AccelerationStructure
 {
 public:
     BVHAcceleration();
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
 
     void SetMaximumChildren(int input);
     void SetNodesOnLeaves(int input);
+    void SetSplitMethod(BVHSplitMethod input);
+
+    // Relative costs of one bounding box test and one primitive test. Used by the SAH build and by GetExpectedCost().
+    void SetTraversalCost(float input);
+    void SetIntersectionCost(float input);
+
+    // Leaves that only hold triangles test them in packets with this kernel instead of one virtual call per
+    // triangle. Unsupported kernels fall back to the best one the CPU has.
+    void SetTriangleKernel(TriangleKernel input);
+
+    // SAH estimate of the work per ray for the built tree, in units of the costs above.
+    float GetExpectedCost() const;
 
 private:
     virtual void InternalInitialization() override;
 
+    // Puts the ray into the space the BVH was built in.
+    struct BoxRay TransformRay(const class SceneObject* parentObject, const class Ray* inputRay) const;
+
+    // Groups the triangles of every triangle-only leaf into packets.
+    void BuildTrianglePackets();
+    // Tests the packets of one leaf. Without an intersection state this stops at the first hit.
+    bool TraceTrianglePackets(int leafOffset, int leafCount, const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+
+    struct TraversalEntry
+    {
+        int nodeIndex;
+        float entryT;
+    };
+
     int maximumChildren;
     int nodesOnLeaves;
+    BVHSplitMethod splitMethod;
+    float traversalCost;
+    float intersectionCost;
+
+    // Depth-first node array (root first) and the primitives in leaf order.
+    std::vector<BVHNode> flatNodes;
+    std::vector<const AccelerationNode*> packedPrimitives;
+    int traversalStackSize;
 
-    std::shared_ptr<class BVHNode> rootNode;
-};
\ No newline at end of file
+    TriangleKernel triangleKernel;
+    std::vector<TrianglePacket> trianglePackets;
+    // First packet of the leaf whose primitives start at this index of packedPrimitives, -1 for leaves that are
+    // not made of triangles only.
+    std::vector<int> leafPacketOffsets;
+};
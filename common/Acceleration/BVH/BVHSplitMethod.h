@@ -0,0 +1,7 @@
+#pragma once
+
+enum class BVHSplitMethod
+{
+    EQUAL_COUNTS,   // sort on a round-robin axis and cut into equally sized chunks
+    SAH             // binned surface area heuristic over all three axes
+};
@@ -0,0 +1,447 @@
+#include "common/Acceleration/BVH/Internal/BVHBuilder.h"
+#include "common/Acceleration/AccelerationNode.h"
+
+namespace
+{
+    const int SAH_BINS = 16;
+
+    // Ranges with at least this many primitives are split up into tasks.
+    const int PARALLEL_BUILD_THRESHOLD = 8192;
+    const int PARALLEL_CHUNK_SIZE = 4096;
+}
+
+BVHBuilder::BVHBuilder(int maximumChildren, int nodesOnLeaves, BVHSplitMethod splitMethod, float traversalCost, float intersectionCost):
+    maximumChildren(maximumChildren), nodesOnLeaves(nodesOnLeaves), splitMethod(splitMethod), traversalCost(traversalCost), intersectionCost(intersectionCost),
+    primitives(nullptr)
+{
+    assert(maximumChildren >= 2 && nodesOnLeaves >= 1);
+    assert(nodesOnLeaves <= std::numeric_limits<uint16_t>::max());
+}
+
+int BVHBuilder::Build(const std::vector<std::shared_ptr<AccelerationNode>>& inputPrimitives, std::vector<BVHNode>& outputNodes, std::vector<const AccelerationNode*>& outputPrimitives)
+{
+    primitives = &inputPrimitives;
+    const int totalPrimitives = static_cast<int>(inputPrimitives.size());
+    const bool buildInParallel = totalPrimitives >= PARALLEL_BUILD_THRESHOLD;
+
+    // Query the bounding boxes once up front instead of on every comparison.
+    buildPrimitives.resize(totalPrimitives);
+    #pragma omp parallel for if (buildInParallel)
+    for (int i = 0; i < totalPrimitives; ++i) {
+        buildPrimitives[i].boundingBox = inputPrimitives[i]->GetBoundingBox();
+        buildPrimitives[i].centroid = buildPrimitives[i].boundingBox.Center();
+        buildPrimitives[i].index = i;
+    }
+    if (buildInParallel) {
+        partitionScratch.resize(totalPrimitives);
+    }
+
+    BuildOutput output;
+    output.nodes.emplace_back();
+    output.primitives.reserve(totalPrimitives);
+
+    #pragma omp parallel if (buildInParallel)
+    #pragma omp single
+    BuildNode(output, 0, 0, totalPrimitives, 0, 0);
+
+    outputNodes.swap(output.nodes);
+    outputPrimitives.swap(output.primitives);
+
+    buildPrimitives.clear();
+    buildPrimitives.shrink_to_fit();
+    partitionScratch.clear();
+    partitionScratch.shrink_to_fit();
+    return output.maximumStackSize;
+}
+
+float BVHBuilder::ComputeExpectedCost(const std::vector<BVHNode>& nodes, float traversalCost, float intersectionCost)
+{
+    if (nodes.empty()) {
+        return 0.f;
+    }
+
+    const float rootArea = nodes[0].boundingBox.SurfaceArea();
+    float cost = 0.f;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        // Degenerate scenes (a single point) have no area to weigh with, every node is always visited then.
+        const float hitProbability = (rootArea > 0.f) ? nodes[i].boundingBox.SurfaceArea() / rootArea : 1.f;
+        cost += traversalCost * hitProbability;
+        if (nodes[i].isLeaf) {
+            cost += intersectionCost * nodes[i].count * hitProbability;
+        }
+    }
+    return cost;
+}
+
+void BVHBuilder::BuildNode(BuildOutput& output, int nodeIndex, int start, int end, int splitDim, int depth)
+{
+    const int totalPrimitives = end - start;
+    if (totalPrimitives <= nodesOnLeaves) {
+        bool createLeaf = true;
+        if (splitMethod == BVHSplitMethod::SAH && totalPrimitives > 1) {
+            // Small enough for a leaf, but splitting further may still be cheaper.
+            int bestAxis, bestBin;
+            float splitCost;
+            if (FindSAHSplit(start, end, RangeBounds(start, end), bestAxis, bestBin, splitCost)) {
+                createLeaf = intersectionCost * totalPrimitives <= splitCost;
+            }
+        }
+
+        if (createLeaf) {
+            BuildLeaf(output, nodeIndex, start, end);
+            return;
+        }
+    }
+
+    std::vector<PrimitiveRange> children;
+    int splitAxis = splitDim;
+    if (splitMethod == BVHSplitMethod::SAH) {
+        SplitSAH(start, end, children, splitAxis);
+    } else {
+        SplitEqualCounts(start, end, splitDim, children);
+    }
+
+    const int totalChildren = static_cast<int>(children.size());
+    assert(totalChildren >= 2);
+    const int nextDim = (splitDim + 1) % 3;
+
+    // Siblings are stored next to each other.
+    const int childOffset = static_cast<int>(output.nodes.size());
+    output.nodes.resize(output.nodes.size() + totalChildren);
+    output.maximumStackSize = std::max(output.maximumStackSize, 1 + (depth + 1) * (maximumChildren - 1));
+
+    if (totalPrimitives >= PARALLEL_BUILD_THRESHOLD) {
+        // The children cover disjoint parts of buildPrimitives, so their subtrees can be built independently.
+        std::vector<BuildOutput> subtrees(totalChildren);
+        for (int i = 0; i < totalChildren; ++i) {
+            #pragma omp task shared(subtrees, children) firstprivate(i)
+            {
+                subtrees[i].nodes.emplace_back();
+                BuildNode(subtrees[i], 0, children[i].start, children[i].end, nextDim, depth + 1);
+            }
+        }
+        #pragma omp taskwait
+
+        // Splice them in the order the serial build would have produced them.
+        for (int i = 0; i < totalChildren; ++i) {
+            AppendSubtree(output, subtrees[i], childOffset + i);
+        }
+    } else {
+        for (int i = 0; i < totalChildren; ++i) {
+            BuildNode(output, childOffset + i, children[i].start, children[i].end, nextDim, depth + 1);
+        }
+    }
+
+    Box boundingBox;
+    for (int i = 0; i < totalChildren; ++i) {
+        boundingBox.IncludeBox(output.nodes[childOffset + i].boundingBox);
+    }
+
+    BVHNode& parent = output.nodes[nodeIndex];
+    parent.boundingBox = boundingBox;
+    parent.offset = childOffset;
+    parent.count = static_cast<uint16_t>(totalChildren);
+    parent.isLeaf = 0;
+    parent.splitAxis = static_cast<uint8_t>(splitAxis);
+}
+
+void BVHBuilder::BuildLeaf(BuildOutput& output, int nodeIndex, int start, int end) const
+{
+    Box boundingBox;
+    BVHNode& leaf = output.nodes[nodeIndex];
+    leaf.offset = static_cast<int32_t>(output.primitives.size());
+    leaf.count = static_cast<uint16_t>(end - start);
+    leaf.isLeaf = 1;
+    leaf.splitAxis = 0;
+    for (int i = start; i < end; ++i) {
+        output.primitives.push_back((*primitives)[buildPrimitives[i].index].get());
+        boundingBox.IncludeBox(buildPrimitives[i].boundingBox);
+    }
+    leaf.boundingBox = boundingBox;
+}
+
+void BVHBuilder::AppendSubtree(BuildOutput& output, const BuildOutput& subtree, int rootIndex)
+{
+    // Node 0 of the subtree goes into its reserved slot, the rest is appended so node i ends up at nodeBase + i.
+    const int nodeBase = static_cast<int>(output.nodes.size()) - 1;
+    const int primitiveBase = static_cast<int>(output.primitives.size());
+
+    for (size_t i = 0; i < subtree.nodes.size(); ++i) {
+        BVHNode node = subtree.nodes[i];
+        node.offset += node.isLeaf ? primitiveBase : nodeBase;
+        if (i == 0) {
+            output.nodes[rootIndex] = node;
+        } else {
+            output.nodes.push_back(node);
+        }
+    }
+
+    output.primitives.insert(output.primitives.end(), subtree.primitives.begin(), subtree.primitives.end());
+    output.maximumStackSize = std::max(output.maximumStackSize, subtree.maximumStackSize);
+}
+
+void BVHBuilder::SplitEqualCounts(int start, int end, int splitDim, std::vector<PrimitiveRange>& children)
+{
+    // Never create more children than there are primitives left.
+    const int totalPrimitives = end - start;
+    const int totalChildren = std::min(maximumChildren, totalPrimitives);
+    const int nodesPerChild = totalPrimitives / totalChildren;
+    assert(nodesPerChild >= 1);
+
+    const auto compareCentroids = [=](const BuildPrimitive& a, const BuildPrimitive& b) {
+        return a.centroid[splitDim] < b.centroid[splitDim];
+    };
+
+    // Only the cut points have to be in sorted position, so partition around each of them instead of sorting everything.
+    for (int i = 0; i < totalChildren; ++i) {
+        PrimitiveRange child;
+        child.start = start + i * nodesPerChild;
+        child.end = (i == totalChildren - 1) ? end : child.start + nodesPerChild;
+        if (child.end != end) {
+            std::nth_element(buildPrimitives.begin() + child.start, buildPrimitives.begin() + child.end, buildPrimitives.begin() + end, compareCentroids);
+        }
+        children.push_back(child);
+    }
+}
+
+void BVHBuilder::SplitSAH(int start, int end, std::vector<PrimitiveRange>& children, int& splitAxis)
+{
+    // Binary SAH splits; wider nodes keep splitting the child with the largest surface area.
+    PrimitiveRange all;
+    all.start = start;
+    all.end = end;
+    all.boundingBox = RangeBounds(start, end);
+    children.push_back(all);
+
+    while (static_cast<int>(children.size()) < maximumChildren) {
+        int largest = -1;
+        float largestArea = -1.f;
+        for (size_t i = 0; i < children.size(); ++i) {
+            const float area = children[i].boundingBox.SurfaceArea();
+            if (children[i].end - children[i].start > 1 && area > largestArea) {
+                largest = static_cast<int>(i);
+                largestArea = area;
+            }
+        }
+        if (largest < 0) {
+            break;
+        }
+
+        const PrimitiveRange parent = children[largest];
+        int axis = 0;
+        const int middle = PartitionSAH(parent.start, parent.end, parent.boundingBox, axis);
+        if (children.size() == 1) {
+            splitAxis = axis;
+        }
+
+        PrimitiveRange left, right;
+        left.start = parent.start;
+        left.end = middle;
+        left.boundingBox = RangeBounds(left.start, left.end);
+        right.start = middle;
+        right.end = parent.end;
+        right.boundingBox = RangeBounds(right.start, right.end);
+
+        // Keep the children in spatial order.
+        children[largest] = left;
+        children.insert(children.begin() + largest + 1, right);
+    }
+}
+
+bool BVHBuilder::FindSAHSplit(int start, int end, const Box& boundingBox, int& bestAxis, int& bestBin, float& bestCost) const
+{
+    struct Bin
+    {
+        Bin() : count(0) {}
+        Box boundingBox;
+        int count;
+    };
+    typedef std::array<std::array<Bin, SAH_BINS>, 3> AxisBins;
+
+    const Box centroidBounds = RangeCentroidBounds(start, end);
+    const float parentArea = boundingBox.SurfaceArea();
+    const float inverseParentArea = (parentArea > 0.f) ? 1.f / parentArea : 0.f;
+
+    // Bin every chunk separately and merge the chunks afterwards. Counts and boxes do not depend on the merge order.
+    std::vector<AxisBins> chunkBins(TotalChunks(start, end));
+    ForEachChunk(start, end, [&](int chunk, int chunkStart, int chunkEnd) {
+        AxisBins& bins = chunkBins[chunk];
+        for (int axis = 0; axis < 3; ++axis) {
+            if (centroidBounds.maxVertex[axis] <= centroidBounds.minVertex[axis]) {
+                continue;
+            }
+            for (int i = chunkStart; i < chunkEnd; ++i) {
+                Bin& bin = bins[axis][CentroidBin(buildPrimitives[i], centroidBounds, axis)];
+                ++bin.count;
+                bin.boundingBox.IncludeBox(buildPrimitives[i].boundingBox);
+            }
+        }
+    });
+
+    AxisBins bins = chunkBins[0];
+    for (size_t c = 1; c < chunkBins.size(); ++c) {
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int b = 0; b < SAH_BINS; ++b) {
+                bins[axis][b].count += chunkBins[c][axis][b].count;
+                bins[axis][b].boundingBox.IncludeBox(chunkBins[c][axis][b].boundingBox);
+            }
+        }
+    }
+
+    bestCost = std::numeric_limits<float>::max();
+    bool foundSplit = false;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (centroidBounds.maxVertex[axis] <= centroidBounds.minVertex[axis]) {
+            continue;
+        }
+
+        // Sweep from the right to get the cost of everything behind each split plane, then sweep from the left.
+        float rightCost[SAH_BINS];
+        Box rightBox;
+        int rightCount = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b) {
+            rightBox.IncludeBox(bins[axis][b].boundingBox);
+            rightCount += bins[axis][b].count;
+            rightCost[b] = (rightCount > 0) ? rightCount * rightBox.SurfaceArea() : -1.f;
+        }
+
+        Box leftBox;
+        int leftCount = 0;
+        for (int b = 1; b < SAH_BINS; ++b) {
+            leftBox.IncludeBox(bins[axis][b - 1].boundingBox);
+            leftCount += bins[axis][b - 1].count;
+            if (leftCount == 0 || rightCost[b] < 0.f) {
+                continue;
+            }
+
+            const float cost = traversalCost + intersectionCost * (leftCount * leftBox.SurfaceArea() + rightCost[b]) * inverseParentArea;
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+                foundSplit = true;
+            }
+        }
+    }
+    return foundSplit;
+}
+
+int BVHBuilder::PartitionSAH(int start, int end, const Box& boundingBox, int& splitAxis)
+{
+    int bestAxis = 0, bestBin = 0;
+    float bestCost;
+    if (FindSAHSplit(start, end, boundingBox, bestAxis, bestBin, bestCost)) {
+        splitAxis = bestAxis;
+        return PartitionRange(start, end, RangeCentroidBounds(start, end), bestAxis, bestBin);
+    }
+
+    // All centroids coincide, so any split is as good as another. Cut the range in half.
+    const int middle = start + (end - start) / 2;
+    splitAxis = 0;
+    return middle;
+}
+
+int BVHBuilder::PartitionRange(int start, int end, const Box& centroidBounds, int axis, int bin)
+{
+    const auto isLeft = [&](const BuildPrimitive& p) {
+        return CentroidBin(p, centroidBounds, axis) < bin;
+    };
+
+    if (end - start < PARALLEL_BUILD_THRESHOLD) {
+        return static_cast<int>(std::partition(buildPrimitives.begin() + start, buildPrimitives.begin() + end, isLeft) - buildPrimitives.begin());
+    }
+
+    // Count per chunk, turn the counts into output positions, then scatter every chunk into the scratch buffer.
+    const int totalChunks = TotalChunks(start, end);
+    std::vector<int> leftCounts(totalChunks, 0);
+    ForEachChunk(start, end, [&](int chunk, int chunkStart, int chunkEnd) {
+        leftCounts[chunk] = static_cast<int>(std::count_if(buildPrimitives.begin() + chunkStart, buildPrimitives.begin() + chunkEnd, isLeft));
+    });
+
+    std::vector<int> leftOffsets(totalChunks), rightOffsets(totalChunks);
+    int totalLeft = 0;
+    for (int c = 0; c < totalChunks; ++c) {
+        leftOffsets[c] = start + totalLeft;
+        totalLeft += leftCounts[c];
+    }
+    int rightOffset = start + totalLeft;
+    for (int c = 0; c < totalChunks; ++c) {
+        rightOffsets[c] = rightOffset;
+        rightOffset += std::min(PARALLEL_CHUNK_SIZE, end - start - c * PARALLEL_CHUNK_SIZE) - leftCounts[c];
+    }
+
+    ForEachChunk(start, end, [&](int chunk, int chunkStart, int chunkEnd) {
+        int left = leftOffsets[chunk];
+        int right = rightOffsets[chunk];
+        for (int i = chunkStart; i < chunkEnd; ++i) {
+            partitionScratch[isLeft(buildPrimitives[i]) ? left++ : right++] = buildPrimitives[i];
+        }
+    });
+    ForEachChunk(start, end, [&](int, int chunkStart, int chunkEnd) {
+        std::copy(partitionScratch.begin() + chunkStart, partitionScratch.begin() + chunkEnd, buildPrimitives.begin() + chunkStart);
+    });
+    return start + totalLeft;
+}
+
+Box BVHBuilder::RangeBounds(int start, int end) const
+{
+    std::vector<Box> chunkBounds(TotalChunks(start, end));
+    ForEachChunk(start, end, [&](int chunk, int chunkStart, int chunkEnd) {
+        for (int i = chunkStart; i < chunkEnd; ++i) {
+            chunkBounds[chunk].IncludeBox(buildPrimitives[i].boundingBox);
+        }
+    });
+
+    Box boundingBox;
+    for (size_t c = 0; c < chunkBounds.size(); ++c) {
+        boundingBox.IncludeBox(chunkBounds[c]);
+    }
+    return boundingBox;
+}
+
+Box BVHBuilder::RangeCentroidBounds(int start, int end) const
+{
+    std::vector<Box> chunkBounds(TotalChunks(start, end));
+    ForEachChunk(start, end, [&](int chunk, int chunkStart, int chunkEnd) {
+        for (int i = chunkStart; i < chunkEnd; ++i) {
+            chunkBounds[chunk].IncludePoint(buildPrimitives[i].centroid);
+        }
+    });
+
+    Box centroidBounds;
+    for (size_t c = 0; c < chunkBounds.size(); ++c) {
+        centroidBounds.IncludeBox(chunkBounds[c]);
+    }
+    return centroidBounds;
+}
+
+int BVHBuilder::CentroidBin(const BuildPrimitive& primitive, const Box& centroidBounds, int axis) const
+{
+    const float extent = centroidBounds.maxVertex[axis] - centroidBounds.minVertex[axis];
+    const int bin = static_cast<int>(SAH_BINS * (primitive.centroid[axis] - centroidBounds.minVertex[axis]) / extent);
+    return glm::clamp(bin, 0, SAH_BINS - 1);
+}
+
+template<typename F>
+void BVHBuilder::ForEachChunk(int start, int end, const F& function) const
+{
+    const int totalChunks = TotalChunks(start, end);
+    if (totalChunks == 1) {
+        function(0, start, end);
+        return;
+    }
+
+    for (int c = 0; c < totalChunks; ++c) {
+        #pragma omp task shared(function) firstprivate(c)
+        function(c, start + c * PARALLEL_CHUNK_SIZE, std::min(end, start + (c + 1) * PARALLEL_CHUNK_SIZE));
+    }
+    #pragma omp taskwait
+}
+
+int BVHBuilder::TotalChunks(int start, int end)
+{
+    if (end - start < PARALLEL_BUILD_THRESHOLD) {
+        return 1;
+    }
+    return (end - start + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+}
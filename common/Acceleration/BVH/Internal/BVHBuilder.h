@@ -0,0 +1,82 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Acceleration/BVH/BVHSplitMethod.h"
+#include "common/Acceleration/BVH/Internal/BVHNode.h"
+
+class AccelerationNode;
+
+// Builds the flattened node array of a BVHAcceleration.
+// Large subtrees are built as OpenMP tasks into their own arrays and spliced into the parent afterwards. Whether a
+// range is processed in parallel only depends on its size, so the tree is the same for any number of threads.
+class BVHBuilder
+{
+public:
+    BVHBuilder(int maximumChildren, int nodesOnLeaves, BVHSplitMethod splitMethod, float traversalCost, float intersectionCost);
+
+    // Fills outputNodes (root first) and outputPrimitives (the primitives in leaf order). Returns the stack size needed to traverse the tree.
+    int Build(const std::vector<std::shared_ptr<AccelerationNode>>& inputPrimitives, std::vector<BVHNode>& outputNodes, std::vector<const AccelerationNode*>& outputPrimitives);
+
+    // Expected cost of tracing a ray through a finished tree according to the surface area heuristic:
+    // every node is weighted by the probability that a ray hitting the root also hits the node.
+    static float ComputeExpectedCost(const std::vector<BVHNode>& nodes, float traversalCost, float intersectionCost);
+
+private:
+    struct BuildPrimitive
+    {
+        Box boundingBox;
+        glm::vec3 centroid;
+        int index;
+    };
+
+    struct PrimitiveRange
+    {
+        int start;
+        int end;
+        Box boundingBox;
+    };
+
+    // Nodes and primitives of one (sub)tree. Offsets are relative to the arrays of the output they live in.
+    struct BuildOutput
+    {
+        BuildOutput() : maximumStackSize(1) {}
+        std::vector<BVHNode> nodes;
+        std::vector<const AccelerationNode*> primitives;
+        int maximumStackSize;
+    };
+
+    void BuildNode(BuildOutput& output, int nodeIndex, int start, int end, int splitDim, int depth);
+    void BuildLeaf(BuildOutput& output, int nodeIndex, int start, int end) const;
+    // Moves a separately built subtree into output; its root goes into the already reserved slot rootIndex.
+    static void AppendSubtree(BuildOutput& output, const BuildOutput& subtree, int rootIndex);
+
+    void SplitEqualCounts(int start, int end, int splitDim, std::vector<PrimitiveRange>& children);
+    void SplitSAH(int start, int end, std::vector<PrimitiveRange>& children, int& splitAxis);
+
+    // Finds the cheapest binned SAH split of [start, end). Returns false if the centroids cannot be separated.
+    bool FindSAHSplit(int start, int end, const Box& boundingBox, int& bestAxis, int& bestBin, float& bestCost) const;
+    // Partitions [start, end) in two halves, using the SAH split if there is one. Returns the first index of the second half.
+    int PartitionSAH(int start, int end, const Box& boundingBox, int& splitAxis);
+    // Moves everything that is left of the split plane to the front of [start, end). Returns the first index right of the plane.
+    int PartitionRange(int start, int end, const Box& centroidBounds, int axis, int bin);
+
+    Box RangeBounds(int start, int end) const;
+    Box RangeCentroidBounds(int start, int end) const;
+    int CentroidBin(const BuildPrimitive& primitive, const Box& centroidBounds, int axis) const;
+
+    // Calls function(chunkIndex, chunkStart, chunkEnd) for consecutive chunks of [start, end). Large ranges are split in
+    // several chunks that run as tasks, small ranges are a single chunk.
+    template<typename F>
+    void ForEachChunk(int start, int end, const F& function) const;
+    static int TotalChunks(int start, int end);
+
+    int maximumChildren;
+    int nodesOnLeaves;
+    BVHSplitMethod splitMethod;
+    float traversalCost;
+    float intersectionCost;
+
+    std::vector<BuildPrimitive> buildPrimitives;
+    std::vector<BuildPrimitive> partitionScratch;
+    const std::vector<std::shared_ptr<AccelerationNode>>* primitives;
+};
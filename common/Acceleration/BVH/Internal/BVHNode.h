@@ -3,19 +3,16 @@
 #include "common/common.h"
 #include "common/Scene/Geometry/Simple/Box/Box.h"
 
-class BVHNode : public std::enable_shared_from_this <BVHNode>
+// One node of the flattened BVH. The nodes live in a single array in depth-first order: the children of an
+// interior node are stored next to each other starting at 'offset', a leaf references 'count' primitives
+// starting at 'offset' in the packed primitive array of the BVH.
+struct BVHNode
 {
-public:
-    BVHNode(std::vector<std::shared_ptr<class AccelerationNode>>& childObjects, int maximumChildren, int nodesOnLeaves, int splitDim = 0);
-    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
-private:
-    void CreateLeafNode(std::vector<std::shared_ptr<class AccelerationNode>>& childObjects);
-    void CreateParentNode(std::vector<std::shared_ptr<class AccelerationNode>>& childObjects, int maximumChildren, int nodesOnLeaves, int splitDim);
-    std::string PrintContents() const;
-
-
-    std::vector<std::shared_ptr<BVHNode>> childBVHNodes;
-    std::vector<std::shared_ptr<class AccelerationNode>> leafNodes;
-    bool isLeafNode;
     Box boundingBox;
-};
\ No newline at end of file
+    int32_t offset;
+    uint16_t count;
+    uint8_t isLeaf;
+    uint8_t splitAxis;
+};
+
+static_assert(sizeof(BVHNode) == 32, "BVHNode is supposed to fit in 32 bytes.");
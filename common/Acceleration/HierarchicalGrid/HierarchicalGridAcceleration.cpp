@@ -0,0 +1,75 @@
+#include "common/Acceleration/HierarchicalGrid/HierarchicalGridAcceleration.h"
+
+HierarchicalGridAcceleration::HierarchicalGridAcceleration():
+    topLevelDensity(1.f), cellDensity(3.f), maximumNodesPerCell(4), topLevelGrid(nullptr)
+{
+}
+
+bool HierarchicalGridAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    assert(topLevelGrid);
+    if (!outputIntersection) {
+        return topLevelGrid->Occluded(parentObject, inputRay);
+    }
+    return topLevelGrid->Trace(parentObject, inputRay, outputIntersection);
+}
+
+bool HierarchicalGridAcceleration::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    assert(topLevelGrid);
+    return topLevelGrid->Occluded(parentObject, inputRay);
+}
+
+void HierarchicalGridAcceleration::InternalInitialization()
+{
+#if !DISABLE_ACCELERATION_CREATION_TIMER
+    DIAGNOSTICS_TIMER(timer, "Hierarchical Grid Creation Time");
+#endif
+    const Box gridBoundingBox = VoxelGrid::ComputeGridBox(nodes);
+    const glm::vec3 gridDiagonal = gridBoundingBox.maxVertex - gridBoundingBox.minVertex;
+    const glm::ivec3 gridSize = VoxelGrid::ComputeResolution(gridDiagonal, nodes.size(), topLevelDensity, MAXIMUM_GRID_RESOLUTION);
+    topLevelGrid = make_unique<VoxelGrid>(gridBoundingBox, gridSize, gridDiagonal / glm::vec3(gridSize));
+    topLevelGrid->Build(nodes);
+
+    // Give every crowded cell a grid of its own, sized by how many nodes ended up in it.
+    subdividedCells.clear();
+    std::vector<int> crowdedCells;
+    std::vector<const AccelerationNode*> cellReplacements;
+    std::vector<int> cellNodeIndices;
+    std::vector<std::shared_ptr<AccelerationNode>> cellNodes;
+    for (int c = 0; c < topLevelGrid->GetTotalCells(); ++c) {
+        topLevelGrid->GetCellNodes(c, cellNodeIndices);
+        if (static_cast<int>(cellNodeIndices.size()) <= maximumNodesPerCell) {
+            continue;
+        }
+
+        cellNodes.clear();
+        for (size_t i = 0; i < cellNodeIndices.size(); ++i) {
+            cellNodes.push_back(nodes[cellNodeIndices[i]]);
+        }
+        const Box cellBox = topLevelGrid->GetCellBox(c);
+        const glm::ivec3 cellSize = VoxelGrid::ComputeResolution(cellBox.maxVertex - cellBox.minVertex, cellNodes.size(), cellDensity, MAXIMUM_GRID_RESOLUTION);
+        subdividedCells.emplace_back(make_unique<GridCellNode>(cellBox, cellSize, cellNodes));
+
+        crowdedCells.push_back(c);
+        cellReplacements.push_back(subdividedCells.back().get());
+    }
+    topLevelGrid->ReplaceCells(crowdedCells, cellReplacements);
+
+    DIAGNOSTICS_LOG("Hierarchical Grid Resolution: " + glm::to_string(gridSize) + " for " + std::to_string(nodes.size()) + " nodes, " + std::to_string(subdividedCells.size()) + " cells subdivided");
+}
+
+void HierarchicalGridAcceleration::SetTopLevelDensity(float input)
+{
+    topLevelDensity = input;
+}
+
+void HierarchicalGridAcceleration::SetCellDensity(float input)
+{
+    cellDensity = input;
+}
+
+void HierarchicalGridAcceleration::SetMaximumNodesPerCell(int input)
+{
+    maximumNodesPerCell = input;
+}
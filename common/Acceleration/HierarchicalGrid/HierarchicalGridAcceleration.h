@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common/Acceleration/AccelerationStructure.h"
+#include "common/Acceleration/UniformGrid/Internal/VoxelGrid.h"
+#include "common/Acceleration/HierarchicalGrid/Internal/GridCellNode.h"
+
+// Two-level grid: a coarse uniform grid over all nodes where every crowded cell gets a finer grid of its own.
+// This keeps a few large nodes (walls, floors) from forcing a fine resolution onto the whole scene.
+class HierarchicalGridAcceleration : public AccelerationStructure
+{
+public:
+    HierarchicalGridAcceleration();
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
+
+    // Voxels per node of the top level grid.
+    void SetTopLevelDensity(float input);
+    // Voxels per node of the grid inside a subdivided cell.
+    void SetCellDensity(float input);
+    // Cells holding more nodes than this are subdivided.
+    void SetMaximumNodesPerCell(int input);
+private:
+    static const int MAXIMUM_GRID_RESOLUTION = 64;
+
+    float topLevelDensity;
+    float cellDensity;
+    int maximumNodesPerCell;
+
+    std::unique_ptr<class VoxelGrid> topLevelGrid;
+    std::vector<std::unique_ptr<class GridCellNode>> subdividedCells;
+
+    virtual void InternalInitialization() override;
+};
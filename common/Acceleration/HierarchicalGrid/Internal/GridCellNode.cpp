@@ -0,0 +1,27 @@
+#include "common/Acceleration/HierarchicalGrid/Internal/GridCellNode.h"
+
+GridCellNode::GridCellNode(const Box& cellBox, const glm::ivec3& size, const std::vector<std::shared_ptr<AccelerationNode>>& cellNodes):
+    boundingBox(cellBox)
+{
+    const glm::vec3 voxelSize = (cellBox.maxVertex - cellBox.minVertex) / glm::vec3(size);
+    voxelGrid = make_unique<VoxelGrid>(cellBox, size, voxelSize);
+    voxelGrid->Build(cellNodes);
+}
+
+Box GridCellNode::GetBoundingBox() const
+{
+    return boundingBox;
+}
+
+bool GridCellNode::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    if (!outputIntersection) {
+        return voxelGrid->Occluded(parentObject, inputRay);
+    }
+    return voxelGrid->Trace(parentObject, inputRay, outputIntersection);
+}
+
+bool GridCellNode::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    return voxelGrid->Occluded(parentObject, inputRay);
+}
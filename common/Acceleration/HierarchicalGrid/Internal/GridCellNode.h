@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common/Acceleration/AccelerationNode.h"
+#include "common/Acceleration/UniformGrid/Internal/VoxelGrid.h"
+
+// A crowded cell of the top level of a hierarchical grid, subdivided by a finer grid of its own.
+class GridCellNode : public AccelerationNode
+{
+public:
+    GridCellNode(const Box& cellBox, const glm::ivec3& size, const std::vector<std::shared_ptr<AccelerationNode>>& cellNodes);
+
+    virtual Box GetBoundingBox() const override;
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
+private:
+    Box boundingBox;
+    std::unique_ptr<VoxelGrid> voxelGrid;
+};
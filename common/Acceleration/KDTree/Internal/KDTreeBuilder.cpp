@@ -0,0 +1,157 @@
+#include "common/Acceleration/KDTree/Internal/KDTreeBuilder.h"
+#include "common/Acceleration/AccelerationNode.h"
+
+KDTreeBuilder::KDTreeBuilder(int maximumDepth, int maximumPrimitivesOnLeaves, float traversalCost, float intersectionCost, float emptyBonus):
+    maximumDepth(maximumDepth), maximumPrimitivesOnLeaves(maximumPrimitivesOnLeaves), traversalCost(traversalCost), intersectionCost(intersectionCost), emptyBonus(emptyBonus),
+    nodes(nullptr), leafPrimitives(nullptr)
+{
+    assert(maximumDepth >= 0 && maximumPrimitivesOnLeaves >= 1);
+}
+
+Box KDTreeBuilder::Build(const std::vector<std::shared_ptr<AccelerationNode>>& inputPrimitives, std::vector<KDTreeNode>& outputNodes, std::vector<int>& outputPrimitives)
+{
+    nodes = &outputNodes;
+    leafPrimitives = &outputPrimitives;
+    nodes->clear();
+    leafPrimitives->clear();
+
+    // Query the bounding boxes once up front instead of on every sweep.
+    Box treeBounds;
+    std::vector<int> rootPrimitives(inputPrimitives.size());
+    primitiveBounds.resize(inputPrimitives.size());
+    for (size_t i = 0; i < inputPrimitives.size(); ++i) {
+        primitiveBounds[i] = inputPrimitives[i]->GetBoundingBox();
+        treeBounds.IncludeBox(primitiveBounds[i]);
+        rootPrimitives[i] = static_cast<int>(i);
+    }
+
+    for (int axis = 0; axis < 3; ++axis) {
+        edges[axis].resize(2 * inputPrimitives.size());
+    }
+    BuildNode(treeBounds, rootPrimitives, 0, 0);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        edges[axis].clear();
+        edges[axis].shrink_to_fit();
+    }
+    primitiveBounds.clear();
+    primitiveBounds.shrink_to_fit();
+    return treeBounds;
+}
+
+void KDTreeBuilder::BuildNode(const Box& nodeBounds, const std::vector<int>& nodePrimitives, int depth, int badRefines)
+{
+    const int totalPrimitives = static_cast<int>(nodePrimitives.size());
+    if (totalPrimitives <= maximumPrimitivesOnLeaves || depth >= maximumDepth) {
+        BuildLeaf(nodePrimitives);
+        return;
+    }
+
+    int bestAxis = -1;
+    int bestOffset = -1;
+    float bestCost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        int offset;
+        float cost;
+        if (FindSplit(nodeBounds, nodePrimitives, axis, offset, cost) && cost < bestCost) {
+            bestAxis = axis;
+            bestOffset = offset;
+            bestCost = cost;
+        }
+    }
+
+    // Splitting is allowed to get worse a few times in a row, it often pays off further down.
+    const float leafCost = intersectionCost * totalPrimitives;
+    if (bestCost > leafCost) {
+        ++badRefines;
+    }
+    if (bestAxis < 0 || (bestCost > 4.f * leafCost && totalPrimitives < 16) || badRefines == 3) {
+        BuildLeaf(nodePrimitives);
+        return;
+    }
+
+    // FindSplit sorted the edges along every axis, so the ones along the best axis are still in order.
+    const std::vector<BoundEdge>& axisEdges = edges[bestAxis];
+    std::vector<int> belowPrimitives, abovePrimitives;
+    for (int i = 0; i < bestOffset; ++i) {
+        if (axisEdges[i].isStart) {
+            belowPrimitives.push_back(axisEdges[i].primitive);
+        }
+    }
+    for (int i = bestOffset + 1; i < 2 * totalPrimitives; ++i) {
+        if (!axisEdges[i].isStart) {
+            abovePrimitives.push_back(axisEdges[i].primitive);
+        }
+    }
+
+    const float splitPosition = axisEdges[bestOffset].position;
+    Box belowBounds = nodeBounds, aboveBounds = nodeBounds;
+    belowBounds.maxVertex[bestAxis] = splitPosition;
+    aboveBounds.minVertex[bestAxis] = splitPosition;
+
+    const int nodeIndex = static_cast<int>(nodes->size());
+    nodes->emplace_back();
+    BuildNode(belowBounds, belowPrimitives, depth + 1, badRefines);
+    (*nodes)[nodeIndex].InitializeInterior(bestAxis, splitPosition, static_cast<int>(nodes->size()));
+    BuildNode(aboveBounds, abovePrimitives, depth + 1, badRefines);
+}
+
+void KDTreeBuilder::BuildLeaf(const std::vector<int>& nodePrimitives)
+{
+    KDTreeNode leaf;
+    leaf.InitializeLeaf(static_cast<int>(leafPrimitives->size()), static_cast<int>(nodePrimitives.size()));
+    nodes->push_back(leaf);
+    leafPrimitives->insert(leafPrimitives->end(), nodePrimitives.begin(), nodePrimitives.end());
+}
+
+bool KDTreeBuilder::FindSplit(const Box& nodeBounds, const std::vector<int>& nodePrimitives, int axis, int& bestOffset, float& bestCost)
+{
+    const int totalPrimitives = static_cast<int>(nodePrimitives.size());
+    std::vector<BoundEdge>& axisEdges = edges[axis];
+    for (int i = 0; i < totalPrimitives; ++i) {
+        const Box& bounds = primitiveBounds[nodePrimitives[i]];
+        axisEdges[2 * i] = BoundEdge{ bounds.minVertex[axis], nodePrimitives[i], true };
+        axisEdges[2 * i + 1] = BoundEdge{ bounds.maxVertex[axis], nodePrimitives[i], false };
+    }
+    std::sort(axisEdges.begin(), axisEdges.begin() + 2 * totalPrimitives);
+
+    const glm::vec3 diagonal = nodeBounds.maxVertex - nodeBounds.minVertex;
+    const float totalArea = nodeBounds.SurfaceArea();
+    if (totalArea <= 0.f) {
+        return false;
+    }
+    const float invTotalArea = 1.f / totalArea;
+    const int otherAxis0 = (axis + 1) % 3;
+    const int otherAxis1 = (axis + 2) % 3;
+    const float capArea = 2.f * diagonal[otherAxis0] * diagonal[otherAxis1];
+    const float sideLength = diagonal[otherAxis0] + diagonal[otherAxis1];
+
+    // Sweep over the edges: every start edge moves a primitive into the lower half once it has been passed, every
+    // end edge moves it out of the upper half as soon as it is reached.
+    bool foundSplit = false;
+    bestCost = std::numeric_limits<float>::max();
+    int totalBelow = 0, totalAbove = totalPrimitives;
+    for (int i = 0; i < 2 * totalPrimitives; ++i) {
+        if (!axisEdges[i].isStart) {
+            --totalAbove;
+        }
+
+        const float position = axisEdges[i].position;
+        if (position > nodeBounds.minVertex[axis] && position < nodeBounds.maxVertex[axis]) {
+            const float belowArea = capArea + 2.f * (position - nodeBounds.minVertex[axis]) * sideLength;
+            const float aboveArea = capArea + 2.f * (nodeBounds.maxVertex[axis] - position) * sideLength;
+            const float bonus = (totalBelow == 0 || totalAbove == 0) ? emptyBonus : 0.f;
+            const float cost = traversalCost + intersectionCost * (1.f - bonus) * (belowArea * invTotalArea * totalBelow + aboveArea * invTotalArea * totalAbove);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestOffset = i;
+                foundSplit = true;
+            }
+        }
+
+        if (axisEdges[i].isStart) {
+            ++totalBelow;
+        }
+    }
+    return foundSplit;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Scene/Geometry/Simple/Box/Box.h"
+#include "common/Acceleration/KDTree/Internal/KDTreeNode.h"
+
+class AccelerationNode;
+
+// Builds the flattened node array of a KDTreeAcceleration. Every node is split at the candidate plane with the
+// lowest SAH cost; candidates are the bounding box faces of the primitives in the node, found with one sorted sweep
+// per axis. Splits that cut off empty space get their cost reduced by the empty bonus so that the tree tightens
+// around the geometry early on.
+class KDTreeBuilder
+{
+public:
+    KDTreeBuilder(int maximumDepth, int maximumPrimitivesOnLeaves, float traversalCost, float intersectionCost, float emptyBonus);
+
+    // Fills outputNodes (root first) and outputPrimitives (indices of the primitives in leaf order; a primitive that
+    // straddles a split plane is referenced from several leaves). Returns the bounds of the whole tree.
+    Box Build(const std::vector<std::shared_ptr<AccelerationNode>>& inputPrimitives, std::vector<KDTreeNode>& outputNodes, std::vector<int>& outputPrimitives);
+
+private:
+    struct BoundEdge
+    {
+        float position;
+        int primitive;
+        bool isStart;
+
+        bool operator<(const BoundEdge& other) const
+        {
+            if (position == other.position) {
+                return isStart && !other.isStart;
+            }
+            return position < other.position;
+        }
+    };
+
+    void BuildNode(const Box& nodeBounds, const std::vector<int>& nodePrimitives, int depth, int badRefines);
+    void BuildLeaf(const std::vector<int>& nodePrimitives);
+
+    // Sorts the edges of the node along axis and finds the cheapest split plane among them. Returns false if no
+    // candidate plane lies strictly inside the node.
+    bool FindSplit(const Box& nodeBounds, const std::vector<int>& nodePrimitives, int axis, int& bestOffset, float& bestCost);
+
+    int maximumDepth;
+    int maximumPrimitivesOnLeaves;
+    float traversalCost;
+    float intersectionCost;
+    float emptyBonus;
+
+    std::vector<Box> primitiveBounds;
+    // Sorted bounding box faces (per axis) of the node that is currently being split, shared by all nodes.
+    std::vector<BoundEdge> edges[3];
+    std::vector<KDTreeNode>* nodes;
+    std::vector<int>* leafPrimitives;
+};
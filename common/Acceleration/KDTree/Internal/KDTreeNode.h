@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common/common.h"
+
+// One node of the flattened kd-tree. The nodes live in a single array in depth-first order: the child below the
+// split plane directly follows its parent, the child above it is stored at GetAboveChild(). A leaf references
+// GetPrimitiveCount() primitives starting at GetPrimitiveOffset() in the leaf primitive array of the tree.
+struct KDTreeNode
+{
+    static const uint32_t LEAF_FLAG = 3;
+
+    void InitializeInterior(int axis, float splitPosition, int aboveChild)
+    {
+        split = splitPosition;
+        flags = static_cast<uint32_t>(axis) | (static_cast<uint32_t>(aboveChild) << 2);
+    }
+
+    void InitializeLeaf(int primitiveOffset, int totalPrimitives)
+    {
+        primitiveCount = static_cast<uint32_t>(totalPrimitives);
+        flags = LEAF_FLAG | (static_cast<uint32_t>(primitiveOffset) << 2);
+    }
+
+    bool IsLeaf() const { return (flags & 3) == LEAF_FLAG; }
+    int GetSplitAxis() const { return static_cast<int>(flags & 3); }
+    float GetSplitPosition() const { return split; }
+    int GetAboveChild() const { return static_cast<int>(flags >> 2); }
+    int GetPrimitiveOffset() const { return static_cast<int>(flags >> 2); }
+    int GetPrimitiveCount() const { return static_cast<int>(primitiveCount); }
+
+private:
+    union
+    {
+        float split;
+        uint32_t primitiveCount;
+    };
+    // The lowest two bits hold the split axis, or LEAF_FLAG. The rest is the above child or the primitive offset.
+    uint32_t flags;
+};
+
+static_assert(sizeof(KDTreeNode) == 8, "KDTreeNode is supposed to fit in 8 bytes.");
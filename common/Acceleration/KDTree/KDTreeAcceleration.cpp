@@ -0,0 +1,155 @@
+#include "common/Acceleration/KDTree/KDTreeAcceleration.h"
+#include "common/Acceleration/KDTree/Internal/KDTreeBuilder.h"
+#include "common/Acceleration/NodeMailbox.h"
+#include "common/Scene/Geometry/Simple/Box/BoxPacket.h"
+#include "common/Scene/SceneObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Intersection/IntersectionState.h"
+
+KDTreeAcceleration::KDTreeAcceleration():
+    maximumDepth(-1), maximumPrimitivesOnLeaves(1), traversalCost(1.f), intersectionCost(80.f), emptyBonus(0.5f)
+{
+}
+
+bool KDTreeAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    return Traverse(parentObject, inputRay, outputIntersection);
+}
+
+bool KDTreeAcceleration::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    return Traverse(parentObject, inputRay, nullptr);
+}
+
+bool KDTreeAcceleration::Traverse(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    if (flatNodes.empty()) {
+        return false;
+    }
+
+    glm::mat4 spaceTransform(1.f);
+    if (parentObject) {
+        spaceTransform = parentObject->GetWorldToObjectMatrix();
+    }
+    const glm::vec3 rayPos = glm::vec3(spaceTransform * inputRay->GetPosition());
+    const glm::vec3 rayDir = glm::vec3(spaceTransform * inputRay->GetForwardDirection());
+
+    const float rayMaxT = inputRay->GetMaxT();
+    float minT, maxT;
+    if (!treeBounds.Trace(rayPos, rayDir, rayMaxT, minT, maxT)) {
+        return false;
+    }
+    minT = std::max(minT, 0.f);
+    maxT = std::min(maxT, rayMaxT);
+
+    // Only used for the (clamped) inverse direction.
+    const BoxRay boxRay(rayPos, rayDir);
+
+    // Primitives that straddle a split plane are referenced from several leaves but only need to be tested once.
+    NodeMailbox mailbox;
+
+    TraversalEntry nodeStack[MAXIMUM_DEPTH_LIMIT + 1];
+    int stackSize = 0;
+
+    bool hitObject = false;
+    int nodeIndex = 0;
+    while (true) {
+        // Everything from here on lies behind the closest hit so far.
+        const float closestT = outputIntersection ? std::min(rayMaxT, outputIntersection->intersectionT) : rayMaxT;
+        if (minT - closestT > SMALL_EPSILON) {
+            break;
+        }
+
+        const KDTreeNode& node = flatNodes[nodeIndex];
+        if (!node.IsLeaf()) {
+            const int axis = node.GetSplitAxis();
+            const float split = node.GetSplitPosition();
+            const float planeT = (split - rayPos[axis]) * boxRay.inverseDirection[axis];
+
+            const bool belowFirst = (rayPos[axis] < split) || (rayPos[axis] == split && boxRay.directionIsNegative[axis]);
+            const int firstChild = belowFirst ? nodeIndex + 1 : node.GetAboveChild();
+            const int secondChild = belowFirst ? node.GetAboveChild() : nodeIndex + 1;
+
+            if (planeT > maxT || planeT <= 0.f) {
+                nodeIndex = firstChild;
+            } else if (planeT < minT) {
+                nodeIndex = secondChild;
+            } else {
+                assert(stackSize <= MAXIMUM_DEPTH_LIMIT);
+                nodeStack[stackSize++] = TraversalEntry{ secondChild, planeT, maxT };
+                nodeIndex = firstChild;
+                maxT = planeT;
+            }
+            continue;
+        }
+
+        const int primitiveOffset = node.GetPrimitiveOffset();
+        for (int i = 0; i < node.GetPrimitiveCount(); ++i) {
+            const int primitiveIndex = leafPrimitives[primitiveOffset + i];
+            if (mailbox.TestAndSet(primitiveIndex)) {
+                continue;
+            }
+
+            const AccelerationNode* primitive = nodes[primitiveIndex].get();
+            if (!outputIntersection) {
+                if (primitive->Occluded(parentObject, inputRay)) {
+                    return true;
+                }
+            } else {
+                hitObject |= primitive->Trace(parentObject, inputRay, outputIntersection);
+            }
+        }
+
+        if (stackSize == 0) {
+            break;
+        }
+        const TraversalEntry& entry = nodeStack[--stackSize];
+        nodeIndex = entry.nodeIndex;
+        minT = entry.minT;
+        maxT = entry.maxT;
+    }
+    return hitObject;
+}
+
+void KDTreeAcceleration::InternalInitialization()
+{
+#if !DISABLE_ACCELERATION_CREATION_TIMER
+    DIAGNOSTICS_TIMER(timer, "KD-Tree Creation Time");
+#endif
+    int depth = maximumDepth;
+    if (depth < 0) {
+        depth = static_cast<int>(std::round(8.f + 1.3f * std::log2(static_cast<float>(std::max<size_t>(nodes.size(), 1)))));
+    }
+    if (depth > MAXIMUM_DEPTH_LIMIT) {
+        std::cerr << "WARNING: Maximum kd-tree depth is too large. Setting it to " << MAXIMUM_DEPTH_LIMIT << "." << std::endl;
+        depth = MAXIMUM_DEPTH_LIMIT;
+    }
+
+    KDTreeBuilder builder(depth, maximumPrimitivesOnLeaves, traversalCost, intersectionCost, emptyBonus);
+    treeBounds = builder.Build(nodes, flatNodes, leafPrimitives);
+}
+
+void KDTreeAcceleration::SetMaximumDepth(int input)
+{
+    maximumDepth = input;
+}
+
+void KDTreeAcceleration::SetMaximumPrimitivesOnLeaves(int input)
+{
+    maximumPrimitivesOnLeaves = input;
+}
+
+void KDTreeAcceleration::SetTraversalCost(float input)
+{
+    traversalCost = input;
+}
+
+void KDTreeAcceleration::SetIntersectionCost(float input)
+{
+    intersectionCost = input;
+}
+
+void KDTreeAcceleration::SetEmptyBonus(float input)
+{
+    emptyBonus = input;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common/Acceleration/AccelerationStructure.h"
+#include "common/Acceleration/KDTree/Internal/KDTreeNode.h"
+
+// SAH kd-tree. Splits empty space off early, which pays off in scenes with large empty regions. Traversal walks the
+// tree front to back with a small stack of far children instead of ropes.
+class KDTreeAcceleration : public AccelerationStructure
+{
+public:
+    KDTreeAcceleration();
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
+
+    // A negative depth picks 8 + 1.3 log2(N), capped at MAXIMUM_DEPTH_LIMIT.
+    void SetMaximumDepth(int input);
+    void SetMaximumPrimitivesOnLeaves(int input);
+
+    // Relative costs of one traversal step and one primitive test.
+    void SetTraversalCost(float input);
+    void SetIntersectionCost(float input);
+    // Fraction of the cost that is taken off splits with an empty side.
+    void SetEmptyBonus(float input);
+
+private:
+    static const int MAXIMUM_DEPTH_LIMIT = 63;
+
+    virtual void InternalInitialization() override;
+
+    // Shared by Trace and Occluded: without an intersection to fill in, the first hit ends the traversal.
+    bool Traverse(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+
+    struct TraversalEntry
+    {
+        int nodeIndex;
+        float minT;
+        float maxT;
+    };
+
+    int maximumDepth;
+    int maximumPrimitivesOnLeaves;
+    float traversalCost;
+    float intersectionCost;
+    float emptyBonus;
+
+    Box treeBounds;
+    // Depth-first node array (root first) and, in leaf order, the indices of the primitives in 'nodes'.
+    std::vector<KDTreeNode> flatNodes;
+    std::vector<int> leafPrimitives;
+};
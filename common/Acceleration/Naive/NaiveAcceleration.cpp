@@ -9,14 +9,24 @@ void NaiveAcceleration::AddNode(std::shared_ptr<AccelerationNode> node)
 
 bool NaiveAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
 {
+    // early exit when we just want to know whether or not we hit.
+    if (!outputIntersection) {
+        return Occluded(parentObject, inputRay);
+    }
+
     bool hasHit = false;
     for (size_t i = 0; i < nodes.size(); ++i) {
-        bool hit = nodes[i]->Trace(parentObject, inputRay, outputIntersection);
-        // early exit when we just want to know whether or not we hit.
-        if (hit && !outputIntersection) {
-            return true; 
-        }
-        hasHit |= hit;
+        hasHit |= nodes[i]->Trace(parentObject, inputRay, outputIntersection);
     }  
     return hasHit;
+}
+
+bool NaiveAcceleration::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i]->Occluded(parentObject, inputRay)) {
+            return true;
+        }
+    }
+    return false;
 }
\ No newline at end of file
@@ -10,4 +10,5 @@ public:
     void AddNode(std::shared_ptr<AccelerationNode> node);
 
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
 };
\ No newline at end of file
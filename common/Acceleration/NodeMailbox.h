@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common/common.h"
+
+// Direct-mapped mailbox of the nodes a single traversal has already tested, for structures that reference a node
+// from several cells or leaves. It lives on the stack of the traversal so that concurrent and nested traversals
+// never share it; a collision only costs a redundant test.
+class NodeMailbox
+{
+public:
+    NodeMailbox() : hits(0)
+    {
+        std::fill(entries, entries + MAILBOX_SIZE, -1);
+    }
+
+    // Returns true if the node has been tested before, otherwise remembers it.
+    bool TestAndSet(int nodeIndex)
+    {
+        int& entry = entries[nodeIndex & (MAILBOX_SIZE - 1)];
+        if (entry == nodeIndex) {
+            ++hits;
+            return true;
+        }
+        entry = nodeIndex;
+        return false;
+    }
+
+    int GetHits() const { return hits; }
+
+private:
+    static const int MAILBOX_SIZE = 16;
+
+    int entries[MAILBOX_SIZE];
+    int hits;
+};
@@ -1,5 +1,7 @@
 #include "common/Acceleration/UniformGrid/Internal/VoxelGrid.h"
 #include "common/Acceleration/AccelerationNode.h"
+#include "common/Acceleration/NodeMailbox.h"
+#include "common/Scene/SceneObject.h"
 #include "common/Intersection/IntersectionState.h"
 
 #define DEBUG_VOXEL_GRID 0
@@ -13,28 +15,126 @@ VoxelGrid::VoxelGrid(Box inputBox, const glm::ivec3& size, const glm::vec3& inpu
     voxelSize *= newVolume / currentVolume;
 }
 
-void VoxelGrid::AddNodeToGrid(std::shared_ptr<AccelerationNode> node)
+void VoxelGrid::Build(const std::vector<std::shared_ptr<AccelerationNode>>& nodes)
 {
-    const Box inputBox = node->GetBoundingBox();
-    // Find all nodes that overlap.
-    glm::ivec3 minNode = GetVoxelForPosition(inputBox.minVertex);
-    glm::ivec3 maxNode = GetVoxelForPosition(inputBox.maxVertex);
+    primitives.resize(nodes.size());
+    std::vector<glm::ivec3> minVoxels(nodes.size()), maxVoxels(nodes.size());
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        primitives[n] = nodes[n].get();
 
+        // Find all voxels that overlap.
+        const Box inputBox = nodes[n]->GetBoundingBox();
+        minVoxels[n] = GetVoxelForPosition(inputBox.minVertex);
+        maxVoxels[n] = GetVoxelForPosition(inputBox.maxVertex);
 #if DEBUG_VOXEL_GRID
-    std::cout << "Add: " << node->GetHumanIdentifier() << std::endl;
-    std::cout << "Min: " << glm::to_string(minNode) << " " << glm::to_string(inputBox.minVertex) << " " << glm::to_string(boundingBox.minVertex) << std::endl;
-    std::cout << "Max: " << glm::to_string(maxNode) << " " << glm::to_string(inputBox.maxVertex) << " " << glm::to_string(boundingBox.maxVertex) << std::endl;
+        std::cout << "Add: " << nodes[n]->GetHumanIdentifier() << std::endl;
+        std::cout << "Min: " << glm::to_string(minVoxels[n]) << " " << glm::to_string(inputBox.minVertex) << " " << glm::to_string(boundingBox.minVertex) << std::endl;
+        std::cout << "Max: " << glm::to_string(maxVoxels[n]) << " " << glm::to_string(inputBox.maxVertex) << " " << glm::to_string(boundingBox.maxVertex) << std::endl;
 #endif
+    }
+
+    // First pass counts the primitives of every cell, which gives the offset of each cell in the packed array.
+    const int totalCells = GetTotalCells();
+    cellOffsets.assign(totalCells + 1, 0);
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        for (int k = minVoxels[n].z; k <= maxVoxels[n].z; ++k) {
+            for (int j = minVoxels[n].y; j <= maxVoxels[n].y; ++j) {
+                for (int i = minVoxels[n].x; i <= maxVoxels[n].x; ++i) {
+                    ++cellOffsets[GetCellIndex(glm::ivec3(i, j, k)) + 1];
+                }
+            }
+        }
+    }
+    for (int c = 0; c < totalCells; ++c) {
+        cellOffsets[c + 1] += cellOffsets[c];
+    }
 
-    for (int i = minNode[0]; i <= maxNode[0]; ++i) {
-        for (int j = minNode[1]; j <= maxNode[1]; ++j) {
-            for (int k = minNode[2]; k <= maxNode[2]; ++k) {
-                grid[i][j][k].AddNode(node);
+    // Second pass fills the cells.
+    cellPrimitives.resize(cellOffsets[totalCells]);
+    std::vector<int> cellFill(cellOffsets.begin(), cellOffsets.end() - 1);
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        for (int k = minVoxels[n].z; k <= maxVoxels[n].z; ++k) {
+            for (int j = minVoxels[n].y; j <= maxVoxels[n].y; ++j) {
+                for (int i = minVoxels[n].x; i <= maxVoxels[n].x; ++i) {
+                    cellPrimitives[cellFill[GetCellIndex(glm::ivec3(i, j, k))]++] = static_cast<int>(n);
+                }
             }
         }
     }
 }
 
+Box VoxelGrid::ComputeGridBox(const std::vector<std::shared_ptr<AccelerationNode>>& nodes)
+{
+    Box gridBoundingBox;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        gridBoundingBox.IncludeBox(nodes[i]->GetBoundingBox());
+    }
+
+    const glm::vec3 gridDiagonal = gridBoundingBox.maxVertex - gridBoundingBox.minVertex;
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(gridDiagonal[i]) < LARGE_EPSILON) {
+            // Arbitrary Expansion
+            gridBoundingBox.maxVertex[i] += 0.1f;
+            gridBoundingBox.minVertex[i] -= 0.1f;
+        }
+    }
+    return gridBoundingBox;
+}
+
+glm::ivec3 VoxelGrid::ComputeResolution(const glm::vec3& extent, size_t totalNodes, float density, int maximumResolution)
+{
+    const float volume = extent.x * extent.y * extent.z;
+    const float voxelsPerUnit = std::cbrt(density * static_cast<float>(totalNodes) / volume);
+    glm::ivec3 resolution;
+    for (int i = 0; i < 3; ++i) {
+        resolution[i] = glm::clamp(static_cast<int>(std::round(extent[i] * voxelsPerUnit)), 1, maximumResolution);
+    }
+    return resolution;
+}
+
+Box VoxelGrid::GetCellBox(int cell) const
+{
+    const glm::ivec3 index(cell % gridSize.x, (cell / gridSize.x) % gridSize.y, cell / (gridSize.x * gridSize.y));
+    const glm::vec3 minVertex = boundingBox.minVertex + glm::vec3(index) * voxelSize;
+    return Box(minVertex, minVertex + voxelSize);
+}
+
+void VoxelGrid::GetCellNodes(int cell, std::vector<int>& output) const
+{
+    output.assign(cellPrimitives.begin() + cellOffsets[cell], cellPrimitives.begin() + cellOffsets[cell + 1]);
+}
+
+void VoxelGrid::ReplaceCells(const std::vector<int>& cells, const std::vector<const AccelerationNode*>& replacements)
+{
+    assert(cells.size() == replacements.size());
+    const int totalCells = GetTotalCells();
+    std::vector<int> replacementIndex(totalCells, -1);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        replacementIndex[cells[i]] = static_cast<int>(primitives.size());
+        primitives.push_back(replacements[i]);
+    }
+
+    std::vector<int> newOffsets(totalCells + 1);
+    std::vector<int> newPrimitives;
+    newPrimitives.reserve(cellPrimitives.size());
+    for (int c = 0; c < totalCells; ++c) {
+        newOffsets[c] = static_cast<int>(newPrimitives.size());
+        if (replacementIndex[c] >= 0) {
+            newPrimitives.push_back(replacementIndex[c]);
+        } else {
+            newPrimitives.insert(newPrimitives.end(), cellPrimitives.begin() + cellOffsets[c], cellPrimitives.begin() + cellOffsets[c + 1]);
+        }
+    }
+    newOffsets[totalCells] = static_cast<int>(newPrimitives.size());
+    cellOffsets.swap(newOffsets);
+    cellPrimitives.swap(newPrimitives);
+}
+
+int VoxelGrid::GetCellIndex(const glm::ivec3& index) const
+{
+    return (index.z * gridSize.y + index.y) * gridSize.x + index.x;
+}
+
 glm::ivec3 VoxelGrid::GetVoxelForPosition(const glm::vec3& position, bool clamp) const
 {
     glm::vec3 positionDiff = (position - boundingBox.minVertex) / voxelSize;
@@ -57,15 +157,14 @@ bool VoxelGrid::IsInsideGrid(const glm::ivec3& index) const
     return true;
 }
 
-bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection)
+bool VoxelGrid::FindFirstVoxel(const SceneObject* parentObject, Ray* inputRay, glm::vec3& rayPos, glm::vec3& rayDir, glm::ivec3& step, glm::ivec3& currentVoxelIndex) const
 {
     glm::mat4 spaceTransform(1.f);
     if (parentObject) {
         spaceTransform = parentObject->GetWorldToObjectMatrix();
     }
-    glm::vec3 rayPos = glm::vec3(spaceTransform * inputRay->GetPosition());
-    const glm::vec3 rayDir = glm::vec3(spaceTransform * inputRay->GetForwardDirection());
-    glm::ivec3 step;
+    rayPos = glm::vec3(spaceTransform * inputRay->GetPosition());
+    rayDir = glm::vec3(spaceTransform * inputRay->GetForwardDirection());
     for (int i = 0; i < 3; ++i) {
         if (std::abs(rayDir[i]) < SMALL_EPSILON) {
             step[i] = 0;
@@ -76,7 +175,7 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
 
     // Implementation of "A Fast Voxel Traversal Algorithm for Ray Tracing" by John Amanatides and Andrew Woo
     // Link: http://www.cse.chalmers.se/edu/year/2010/course/TDA361/grid.pdf
-    glm::ivec3 currentVoxelIndex = GetVoxelForPosition(rayPos, false);
+    currentVoxelIndex = GetVoxelForPosition(rayPos, false);
 #if DEBUG_VOXEL_GRID
     std::cout << "Initial Voxel Position: " << glm::to_string(currentVoxelIndex) << " for " << glm::to_string(rayPos) << " going " << glm::to_string(rayDir) << std::endl;
 #endif
@@ -95,40 +194,102 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
     std::cout << "Scene Bounding: " << glm::to_string(boundingBox.minVertex) << " " << glm::to_string(boundingBox.maxVertex) << std::endl;
     std::cout << "Voxel Size: " << glm::to_string(voxelSize) << std::endl;
 #endif
+    return true;
+}
+
+bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    glm::vec3 rayPos, rayDir;
+    glm::ivec3 step, currentVoxelIndex;
+    if (!FindFirstVoxel(parentObject, inputRay, rayPos, rayDir, step, currentVoxelIndex)) {
+        return false;
+    }
+
+    NodeMailbox mailbox;
+    int voxelsVisited = 0;
+
+    bool hitObject = false;
     while (IsInsideGrid(currentVoxelIndex)) {
 #if DEBUG_VOXEL_GRID
         std::cout << "Trace Voxel: " << glm::to_string(currentVoxelIndex) << std::endl;
 #endif
-        IntersectionState tempIntersection;
-        tempIntersection.TestAndCopyLimits(outputIntersection);
-        bool hitVoxel = grid[currentVoxelIndex[0]][currentVoxelIndex[1]][currentVoxelIndex[2]].Trace(parentObject, inputRay, &tempIntersection);
-            
-        // Need to verify that the hit position is within the voxel -- otherwise we're looking too far ahead.
-        const glm::vec3 hitPosition = rayPos + rayDir * tempIntersection.intersectionT;
-#if DEBUG_VOXEL_GRID
-        std::cout << "  -- hit position " << glm::to_string(hitPosition) << " " << glm::to_string(GetVoxelForPosition(hitPosition)) << std::endl;
-#endif
-        if (hitVoxel && GetVoxelForPosition(hitPosition) == currentVoxelIndex)  {
-            if (outputIntersection) {
-                *outputIntersection = tempIntersection;
+        ++voxelsVisited;
+        const int cell = GetCellIndex(currentVoxelIndex);
+        for (int p = cellOffsets[cell]; p < cellOffsets[cell + 1]; ++p) {
+            if (mailbox.TestAndSet(cellPrimitives[p])) {
+                continue;
             }
-#if DEBUG_VOXEL_GRID
-            std::cout << " did done hit" << std::endl;
-#endif
-            return true;
+            hitObject |= primitives[cellPrimitives[p]]->Trace(parentObject, inputRay, outputIntersection);
         }
 
         int minIndex = 0;
         float minTMax = 0.f;
         FindClosestVoxelSide(minIndex, minTMax, currentVoxelIndex, step, rayPos, rayDir);
         assert(minIndex >= 0);
+
+        // A hit may lie beyond this voxel, in which case a primitive in a later voxel can still be closer.
+        // Once the closest hit so far lies within the voxels visited so far, nothing that follows can beat it.
+        const float maxT = outputIntersection ? std::min(inputRay->GetMaxT(), outputIntersection->intersectionT) : inputRay->GetMaxT();
+        if (maxT - minTMax < SMALL_EPSILON) {
+#if DEBUG_VOXEL_GRID
+            std::cout << " did done hit" << std::endl;
+#endif
+            break;
+        }
         currentVoxelIndex[minIndex] += step[minIndex];
 
 #if DEBUG_VOXEL_GRID
         std::cout << " -- next voxel: " << glm::to_string(currentVoxelIndex) << " " << minIndex << " " << minTMax << std::endl;
 #endif
     }
-    return false;
+    DIAGNOSTICS_STAT_ADD(DiagnosticsType::GRID_VOXELS_VISITED, voxelsVisited);
+    DIAGNOSTICS_STAT_ADD(DiagnosticsType::GRID_MAILBOX_HITS, mailbox.GetHits());
+    return hitObject;
+}
+
+bool VoxelGrid::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    glm::vec3 rayPos, rayDir;
+    glm::ivec3 step, currentVoxelIndex;
+    if (!FindFirstVoxel(parentObject, inputRay, rayPos, rayDir, step, currentVoxelIndex)) {
+        return false;
+    }
+
+    NodeMailbox mailbox;
+    int voxelsVisited = 0;
+
+    // Any hit along the ray will do, so there is no need to check that it lies within the current voxel.
+    bool occluded = false;
+    while (IsInsideGrid(currentVoxelIndex)) {
+        ++voxelsVisited;
+        const int cell = GetCellIndex(currentVoxelIndex);
+        for (int p = cellOffsets[cell]; p < cellOffsets[cell + 1]; ++p) {
+            if (mailbox.TestAndSet(cellPrimitives[p])) {
+                continue;
+            }
+            if (primitives[cellPrimitives[p]]->Occluded(parentObject, inputRay)) {
+                occluded = true;
+                break;
+            }
+        }
+        if (occluded) {
+            break;
+        }
+
+        int minIndex = 0;
+        float minTMax = 0.f;
+        FindClosestVoxelSide(minIndex, minTMax, currentVoxelIndex, step, rayPos, rayDir);
+        assert(minIndex >= 0);
+
+        // The next voxel starts behind the end of the ray.
+        if (minTMax - inputRay->GetMaxT() > SMALL_EPSILON) {
+            break;
+        }
+        currentVoxelIndex[minIndex] += step[minIndex];
+    }
+    DIAGNOSTICS_STAT_ADD(DiagnosticsType::GRID_VOXELS_VISITED, voxelsVisited);
+    DIAGNOSTICS_STAT_ADD(DiagnosticsType::GRID_MAILBOX_HITS, mailbox.GetHits());
+    return occluded;
 }
 
 void VoxelGrid::FindClosestVoxelSide(int& dim, float& t, const glm::ivec3& currentVoxelIndex, const glm::ivec3& step, const glm::vec3& rayPos, const glm::vec3& rayDir) const
@@ -1,18 +1,33 @@
 #pragma once
 
 #include "common/common.h"
-#include "common/Acceleration/UniformGrid/Internal/Voxel.h"
 #include "common/Scene/Geometry/Simple/Box/Box.h"
-#include <unordered_map>
 
 class VoxelGrid : public std::enable_shared_from_this<VoxelGrid>
 {
 public:
     VoxelGrid(Box inputBox, const glm::ivec3& size, const glm::vec3& inputSize);
 
-    void AddNodeToGrid(std::shared_ptr<class AccelerationNode> node);
-    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection);
+    // Sorts the nodes into the voxels they overlap: one pass counts the nodes per voxel, the second one fills them in.
+    void Build(const std::vector<std::shared_ptr<class AccelerationNode>>& nodes);
+    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+    bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const;
+
+    // Bounds of all nodes, padded along axes where they are flat.
+    static Box ComputeGridBox(const std::vector<std::shared_ptr<class AccelerationNode>>& nodes);
+    // Cube-root heuristic: cubical voxels such that there are about density voxels per node, clamped per axis.
+    static glm::ivec3 ComputeResolution(const glm::vec3& extent, size_t totalNodes, float density, int maximumResolution);
+
+    int GetTotalCells() const { return gridSize.x * gridSize.y * gridSize.z; }
+    Box GetCellBox(int cell) const;
+    // Indices (into the nodes passed to Build) of the nodes that overlap the cell.
+    void GetCellNodes(int cell, std::vector<int>& output) const;
+    // Swaps out the contents of each of the given cells for a single node. The replacement nodes must outlive the grid.
+    void ReplaceCells(const std::vector<int>& cells, const std::vector<const class AccelerationNode*>& replacements);
 private:
+    int GetCellIndex(const glm::ivec3& index) const;
+    // Transforms the ray into the space of the grid and finds the voxel it starts in. Returns false if the ray misses the grid.
+    bool FindFirstVoxel(const class SceneObject* parentObject, class Ray* inputRay, glm::vec3& rayPos, glm::vec3& rayDir, glm::ivec3& step, glm::ivec3& currentVoxelIndex) const;
     bool IsInsideGrid(const glm::ivec3& index) const;
     glm::ivec3 GetVoxelForPosition(const glm::vec3& position, bool clamp = true) const;
     void FindClosestVoxelSide(int& dim, float& t, const glm::ivec3& currentVoxelIndex, const glm::ivec3& step, const glm::vec3& rayPos, const glm::vec3& rayDir) const;
@@ -20,5 +35,9 @@ private:
     Box boundingBox;
     glm::ivec3 gridSize;
     glm::vec3 voxelSize;
-    std::unordered_map<int, std::unordered_map<int, std::unordered_map<int, Voxel>>> grid;
+
+    std::vector<const class AccelerationNode*> primitives;
+    // The nodes in voxel c are cellPrimitives[cellOffsets[c]] up to (excluding) cellPrimitives[cellOffsets[c + 1]].
+    std::vector<int> cellOffsets;
+    std::vector<int> cellPrimitives;
 };
\ No newline at end of file
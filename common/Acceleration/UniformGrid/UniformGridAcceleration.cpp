@@ -3,45 +3,51 @@
 #include "common/Scene/Geometry/Ray/Ray.h"
 
 UniformGridAcceleration::UniformGridAcceleration():
-    gridSize(20, 10, 20), voxelGrid(nullptr)
+    gridSize(20, 10, 20), useSuggestedGridSize(false), gridDensity(3.f), voxelGrid(nullptr)
 {
 }
 
 bool UniformGridAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
 {
     assert(voxelGrid);
+    if (!outputIntersection) {
+        return voxelGrid->Occluded(parentObject, inputRay);
+    }
     return voxelGrid->Trace(parentObject, inputRay, outputIntersection);
 }
 
+bool UniformGridAcceleration::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    assert(voxelGrid);
+    return voxelGrid->Occluded(parentObject, inputRay);
+}
+
 void UniformGridAcceleration::InternalInitialization()
 {
-    Box gridBoundingBox;
 #if !DISABLE_ACCELERATION_CREATION_TIMER
     DIAGNOSTICS_TIMER(timer, "Uniform Grid Creation Time");
 #endif
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        gridBoundingBox.IncludeBox(nodes[i]->GetBoundingBox());
-    }
+    const Box gridBoundingBox = VoxelGrid::ComputeGridBox(nodes);
+    const glm::vec3 gridDiagonal = gridBoundingBox.maxVertex - gridBoundingBox.minVertex;
 
-    glm::vec3 gridDiagonal = gridBoundingBox.maxVertex - gridBoundingBox.minVertex;
-    for (int i = 0; i < 3; ++i) {
-        if (std::abs(gridDiagonal[i]) < LARGE_EPSILON) {
-            // Arbitrary Expansion
-            gridBoundingBox.maxVertex[i] += 0.1f;
-            gridBoundingBox.minVertex[i] -= 0.1f;
-        }
+    if (!useSuggestedGridSize) {
+        gridSize = VoxelGrid::ComputeResolution(gridDiagonal, nodes.size(), gridDensity, MAXIMUM_GRID_RESOLUTION);
     }
-    gridDiagonal = gridBoundingBox.maxVertex - gridBoundingBox.minVertex;
+    DIAGNOSTICS_LOG("Uniform Grid Resolution: " + glm::to_string(gridSize) + " for " + std::to_string(nodes.size()) + " nodes");
 
     glm::vec3 voxelSize = gridDiagonal / glm::vec3(gridSize);
     voxelGrid = make_unique<VoxelGrid>(gridBoundingBox, gridSize, voxelSize);
 
-    for (size_t i = 0; i < nodes.size(); ++i) {
-        voxelGrid->AddNodeToGrid(nodes[i]);
-    }
+    voxelGrid->Build(nodes);
 }
 
 void UniformGridAcceleration::SetSuggestedGridSize(glm::ivec3 input)
 {
     gridSize = input;
+    useSuggestedGridSize = true;
+}
+
+void UniformGridAcceleration::SetGridDensity(float input)
+{
+    gridDensity = input;
 }
@@ -8,10 +8,18 @@ class UniformGridAcceleration : public AccelerationStructure
 public:
     UniformGridAcceleration();
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
 
+    // Fixes the grid resolution instead of deriving it from the number of nodes.
     void SetSuggestedGridSize(glm::ivec3 input);
+    // Target number of voxels per node when the resolution is chosen automatically.
+    void SetGridDensity(float input);
 private:
+    static const int MAXIMUM_GRID_RESOLUTION = 128;
+
     glm::ivec3 gridSize;
+    bool useSuggestedGridSize;
+    float gridDensity;
     std::unique_ptr<class VoxelGrid> voxelGrid;
 
     virtual void InternalInitialization() override;
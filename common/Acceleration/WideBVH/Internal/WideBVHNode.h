@@ -0,0 +1,25 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Scene/Geometry/Simple/Box/BoxPacket.h"
+
+// One node of a wide BVH. The bounds of all N children sit next to each other so one packed slab test covers them.
+template<int N>
+struct WideBVHNode
+{
+    WideBVHNode()
+    {
+        for (int i = 0; i < N; ++i) {
+            childIndex[i] = 0;
+            childCount[i] = EMPTY_CHILD;
+        }
+    }
+
+    static const int32_t EMPTY_CHILD = -1;
+
+    BoxPacket<N> childBounds;
+    // Interior children: index into the node array. Leaf children: first primitive in the packed primitive array.
+    int32_t childIndex[N];
+    // 0 for interior children, the number of primitives for leaves and EMPTY_CHILD for unused lanes.
+    int32_t childCount[N];
+};
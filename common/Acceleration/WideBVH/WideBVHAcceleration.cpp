@@ -0,0 +1,270 @@
+#include "common/Acceleration/WideBVH/WideBVHAcceleration.h"
+#include "common/Acceleration/BVH/Internal/BVHBuilder.h"
+#include "common/Scene/SceneObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Intersection/IntersectionState.h"
+
+namespace
+{
+    const int LOCAL_STACK_SIZE = 128;
+
+    // Either a node that still has to be tested or a leaf whose primitives have to be intersected.
+    struct TraversalEntry
+    {
+        int index;
+        int count;
+        float entryT;
+    };
+
+    BoxRay TransformRay(const SceneObject* parentObject, const Ray* inputRay)
+    {
+        glm::mat4 spaceTransform(1.f);
+        if (parentObject) {
+            spaceTransform = parentObject->GetWorldToObjectMatrix();
+        }
+        return BoxRay(glm::vec3(spaceTransform * inputRay->GetPosition()), glm::vec3(spaceTransform * inputRay->GetForwardDirection()));
+    }
+}
+
+WideBVHAcceleration::WideBVHAcceleration():
+#if defined(__AVX__)
+    width(8),
+#else
+    width(4),
+#endif
+    nodesOnLeaves(4), traversalCost(0.125f), intersectionCost(1.f), traversalStackSize(1)
+{
+}
+
+bool WideBVHAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    if (!outputIntersection) {
+        return Occluded(parentObject, inputRay);
+    }
+    if (width == 8) {
+        return TraceNodes(nodes8, parentObject, inputRay, outputIntersection);
+    }
+    return TraceNodes(nodes4, parentObject, inputRay, outputIntersection);
+}
+
+bool WideBVHAcceleration::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    if (width == 8) {
+        return OccludedNodes(nodes8, parentObject, inputRay);
+    }
+    return OccludedNodes(nodes4, parentObject, inputRay);
+}
+
+template<int N>
+bool WideBVHAcceleration::TraceNodes(const std::vector<WideBVHNode<N>>& wideNodes, const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    if (wideNodes.empty()) {
+        return false;
+    }
+
+    const BoxRay boxRay = TransformRay(parentObject, inputRay);
+    const float rayMaxT = inputRay->GetMaxT();
+
+    TraversalEntry localStack[LOCAL_STACK_SIZE];
+    std::vector<TraversalEntry> overflowStack;
+    TraversalEntry* nodeStack = localStack;
+    if (traversalStackSize > LOCAL_STACK_SIZE) {
+        overflowStack.resize(traversalStackSize);
+        nodeStack = overflowStack.data();
+    }
+
+    int stackSize = 0;
+    nodeStack[stackSize++] = TraversalEntry{ 0, 0, std::numeric_limits<float>::lowest() };
+
+    bool hitObject = false;
+    float entryT[N];
+    while (stackSize > 0) {
+        const TraversalEntry entry = nodeStack[--stackSize];
+        const float maxT = std::min(rayMaxT, outputIntersection->intersectionT);
+
+        // A closer hit may have been found since this entry was pushed.
+        if (entry.entryT - maxT > SMALL_EPSILON) {
+            continue;
+        }
+
+        if (entry.count > 0) {
+            for (int i = 0; i < entry.count; ++i) {
+                hitObject |= packedPrimitives[entry.index + i]->Trace(parentObject, inputRay, outputIntersection);
+            }
+            continue;
+        }
+
+        const WideBVHNode<N>& node = wideNodes[entry.index];
+        const int hitMask = node.childBounds.Trace(boxRay, maxT, entryT);
+        const int firstChild = stackSize;
+        for (int i = 0; i < N; ++i) {
+            if ((hitMask & (1 << i)) && node.childCount[i] != WideBVHNode<N>::EMPTY_CHILD) {
+                nodeStack[stackSize++] = TraversalEntry{ node.childIndex[i], node.childCount[i], entryT[i] };
+            }
+        }
+
+        // Far children go to the bottom so that the nearest one is visited first.
+        std::sort(nodeStack + firstChild, nodeStack + stackSize, [](const TraversalEntry& a, const TraversalEntry& b) {
+            return a.entryT > b.entryT;
+        });
+    }
+    return hitObject;
+}
+
+template<int N>
+bool WideBVHAcceleration::OccludedNodes(const std::vector<WideBVHNode<N>>& wideNodes, const SceneObject* parentObject, Ray* inputRay) const
+{
+    if (wideNodes.empty()) {
+        return false;
+    }
+
+    const BoxRay boxRay = TransformRay(parentObject, inputRay);
+    const float maxT = inputRay->GetMaxT();
+
+    int localStack[LOCAL_STACK_SIZE];
+    std::vector<int> overflowStack;
+    int* nodeStack = localStack;
+    if (traversalStackSize > LOCAL_STACK_SIZE) {
+        overflowStack.resize(traversalStackSize);
+        nodeStack = overflowStack.data();
+    }
+
+    int stackSize = 0;
+    nodeStack[stackSize++] = 0;
+
+    // Leaves are intersected right away since any hit ends the query.
+    float entryT[N];
+    while (stackSize > 0) {
+        const WideBVHNode<N>& node = wideNodes[nodeStack[--stackSize]];
+        const int hitMask = node.childBounds.Trace(boxRay, maxT, entryT);
+        for (int i = 0; i < N; ++i) {
+            if (!(hitMask & (1 << i)) || node.childCount[i] == WideBVHNode<N>::EMPTY_CHILD) {
+                continue;
+            }
+
+            if (node.childCount[i] == 0) {
+                nodeStack[stackSize++] = node.childIndex[i];
+                continue;
+            }
+
+            for (int p = 0; p < node.childCount[i]; ++p) {
+                if (packedPrimitives[node.childIndex[i] + p]->Occluded(parentObject, inputRay)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void WideBVHAcceleration::InternalInitialization()
+{
+#if !DISABLE_ACCELERATION_CREATION_TIMER
+    DIAGNOSTICS_TIMER(timer, "Wide BVH Creation Time");
+#endif
+    if (width != 4 && width != 8) {
+        std::cerr << "WARNING: Wide BVH only supports 4 or 8 children. Using 4." << std::endl;
+        width = 4;
+    }
+
+    // Start from a binary SAH tree; collapsing it keeps the SAH splits while filling the wide nodes.
+    std::vector<BVHNode> binaryNodes;
+    BVHBuilder builder(2, nodesOnLeaves, BVHSplitMethod::SAH, traversalCost, intersectionCost);
+    builder.Build(nodes, binaryNodes, packedPrimitives);
+
+    nodes4.clear();
+    nodes8.clear();
+    if (width == 8) {
+        Collapse(binaryNodes, nodes8);
+    } else {
+        Collapse(binaryNodes, nodes4);
+    }
+}
+
+template<int N>
+void WideBVHAcceleration::Collapse(const std::vector<BVHNode>& binaryNodes, std::vector<WideBVHNode<N>>& wideNodes)
+{
+    traversalStackSize = 1;
+    if (packedPrimitives.empty()) {
+        return;
+    }
+    CollapseNode(binaryNodes, 0, wideNodes, 0);
+}
+
+template<int N>
+int WideBVHAcceleration::CollapseNode(const std::vector<BVHNode>& binaryNodes, int binaryIndex, std::vector<WideBVHNode<N>>& wideNodes, int depth)
+{
+    // Each wide node pops one stack entry and pushes up to N.
+    traversalStackSize = std::max(traversalStackSize, 1 + (depth + 1) * (N - 1));
+
+    // Pull grandchildren up into this node, always opening the interior child with the largest surface area.
+    std::vector<int> children;
+    const BVHNode& binaryNode = binaryNodes[binaryIndex];
+    if (binaryNode.isLeaf) {
+        children.push_back(binaryIndex);
+    } else {
+        for (int i = 0; i < binaryNode.count; ++i) {
+            children.push_back(binaryNode.offset + i);
+        }
+    }
+
+    while (static_cast<int>(children.size()) < N) {
+        int largest = -1;
+        float largestArea = -1.f;
+        for (size_t i = 0; i < children.size(); ++i) {
+            const BVHNode& child = binaryNodes[children[i]];
+            if (!child.isLeaf && child.count <= N - static_cast<int>(children.size()) + 1 && child.boundingBox.SurfaceArea() > largestArea) {
+                largest = static_cast<int>(i);
+                largestArea = child.boundingBox.SurfaceArea();
+            }
+        }
+        if (largest < 0) {
+            break;
+        }
+
+        const BVHNode& opened = binaryNodes[children[largest]];
+        children.erase(children.begin() + largest);
+        for (int i = 0; i < opened.count; ++i) {
+            children.insert(children.begin() + largest + i, opened.offset + i);
+        }
+    }
+
+    const int wideIndex = static_cast<int>(wideNodes.size());
+    wideNodes.emplace_back();
+    for (size_t i = 0; i < children.size(); ++i) {
+        const BVHNode& child = binaryNodes[children[i]];
+        int childIndex = child.offset;
+        int childCount = child.count;
+        if (!child.isLeaf) {
+            childIndex = CollapseNode(binaryNodes, children[i], wideNodes, depth + 1);
+            childCount = 0;
+        }
+
+        // The recursion may have moved the node array.
+        WideBVHNode<N>& wideNode = wideNodes[wideIndex];
+        wideNode.childBounds.SetBox(static_cast<int>(i), child.boundingBox);
+        wideNode.childIndex[i] = childIndex;
+        wideNode.childCount[i] = childCount;
+    }
+    return wideIndex;
+}
+
+void WideBVHAcceleration::SetWidth(int input)
+{
+    width = input;
+}
+
+void WideBVHAcceleration::SetNodesOnLeaves(int input)
+{
+    nodesOnLeaves = input;
+}
+
+void WideBVHAcceleration::SetTraversalCost(float input)
+{
+    traversalCost = input;
+}
+
+void WideBVHAcceleration::SetIntersectionCost(float input)
+{
+    intersectionCost = input;
+}
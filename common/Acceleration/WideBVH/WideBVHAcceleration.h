@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common/Acceleration/AccelerationStructure.h"
+#include "common/Acceleration/WideBVH/Internal/WideBVHNode.h"
+
+// BVH with 4 or 8 children per node. A binary SAH tree is built first and then collapsed so that every node holds
+// the bounds of all its children in one BoxPacket, which traversal tests with a single SIMD slab test.
+class WideBVHAcceleration : public AccelerationStructure
+{
+public:
+    WideBVHAcceleration();
+    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
+
+    // Either 4 or 8. Defaults to 8 when compiled with AVX and to 4 otherwise.
+    void SetWidth(int input);
+    void SetNodesOnLeaves(int input);
+
+    // Relative costs of one bounding box test and one primitive test, see BVHAcceleration.
+    void SetTraversalCost(float input);
+    void SetIntersectionCost(float input);
+
+private:
+    virtual void InternalInitialization() override;
+
+    template<int N>
+    void Collapse(const std::vector<struct BVHNode>& binaryNodes, std::vector<WideBVHNode<N>>& wideNodes);
+    template<int N>
+    int CollapseNode(const std::vector<struct BVHNode>& binaryNodes, int binaryIndex, std::vector<WideBVHNode<N>>& wideNodes, int depth);
+
+    template<int N>
+    bool TraceNodes(const std::vector<WideBVHNode<N>>& wideNodes, const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+    template<int N>
+    bool OccludedNodes(const std::vector<WideBVHNode<N>>& wideNodes, const class SceneObject* parentObject, class Ray* inputRay) const;
+
+    int width;
+    int nodesOnLeaves;
+    float traversalCost;
+    float intersectionCost;
+
+    // Only the array matching the width is used.
+    std::vector<WideBVHNode<4>> nodes4;
+    std::vector<WideBVHNode<8>> nodes8;
+    std::vector<const AccelerationNode*> packedPrimitives;
+    int traversalStackSize;
+};
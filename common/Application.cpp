@@ -2,6 +2,11 @@
 #include "common/Acceleration/AccelerationCommon.h"
 #include "common/Output/ImageWriter.h"
 
+Application::Application():
+    renderRegionSet(false)
+{
+}
+
 std::string Application::GetOutputFilename() const
 {
     return "output.png";
@@ -12,11 +17,50 @@ int Application::GetSamplesPerPixel() const
     return 16;
 }
 
+int Application::GetProgressivePasses() const
+{
+    return 1;
+}
+
 glm::vec2 Application::GetImageOutputResolution() const
 {
     return glm::vec2(1280.f, 720.f);
 }
 
+glm::ivec2 Application::GetRenderTileSize() const
+{
+    return glm::ivec2(32, 32);
+}
+
+void Application::SetRenderRegion(const glm::ivec2& minPixel, const glm::ivec2& maxPixel)
+{
+    renderRegionSet = true;
+    renderRegionMin = minPixel;
+    renderRegionMax = maxPixel;
+}
+
+void Application::GetRenderRegion(glm::ivec2& minPixel, glm::ivec2& maxPixel) const
+{
+    const glm::ivec2 resolution(GetImageOutputResolution());
+    if (!renderRegionSet) {
+        minPixel = glm::ivec2(0, 0);
+        maxPixel = resolution;
+        return;
+    }
+    minPixel = glm::clamp(renderRegionMin, glm::ivec2(0, 0), resolution);
+    maxPixel = glm::clamp(renderRegionMax, minPixel, resolution);
+}
+
+void Application::SetHDRBufferFilename(const std::string& input)
+{
+    hdrBufferFilename = input;
+}
+
+std::string Application::GetHDRBufferFilename() const
+{
+    return hdrBufferFilename;
+}
+
 void Application::PerformImagePostprocessing(class ImageWriter&)
 {
 }
\ No newline at end of file
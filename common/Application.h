@@ -7,6 +7,7 @@ enum class AccelerationTypes;
 class Application : public std::enable_shared_from_this<Application>
 {
 public:
+    Application();
     virtual ~Application() {}
     virtual std::shared_ptr<class Camera> CreateCamera() const = 0;
     virtual std::shared_ptr<class Scene> CreateScene() const = 0;
@@ -20,8 +21,23 @@ public:
     // output
     virtual glm::vec2 GetImageOutputResolution() const;
 
+    // Size of the image tiles that are handed out to the render threads.
+    virtual glm::ivec2 GetRenderTileSize() const;
+
+    // Only pixels in [minPixel, maxPixel) are traced. Defaults to the whole image.
+    void SetRenderRegion(const glm::ivec2& minPixel, const glm::ivec2& maxPixel);
+    virtual void GetRenderRegion(glm::ivec2& minPixel, glm::ivec2& maxPixel) const;
+
+    // Raw HDR buffer that gets loaded before rendering and written back afterwards, so region renders
+    // can be merged into an earlier full frame. Empty means start from a black image and don't store it.
+    void SetHDRBufferFilename(const std::string& input);
+    virtual std::string GetHDRBufferFilename() const;
+
     // Sampling Properties
     virtual int GetSamplesPerPixel() const;
+    // The image is rendered this many times with GetSamplesPerPixel() samples each and the passes are averaged. The
+    // HDR buffer (if there is one) is written after every pass, so a render that gets stopped still leaves its result so far.
+    virtual int GetProgressivePasses() const;
 
     // whether or not to continue sampling the scene from the camera.
     virtual bool NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex) = 0;
@@ -31,4 +47,9 @@ public:
 
     virtual std::string GetOutputFilename() const;
 private:
+    bool renderRegionSet;
+    glm::ivec2 renderRegionMin;
+    glm::ivec2 renderRegionMax;
+
+    std::string hdrBufferFilename;
 };
\ No newline at end of file
@@ -1,13 +1,41 @@
 #include "common/Intersection/IntersectionState.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Scene/SceneObject.h"
+
+void IntersectionState::UpdateShadingFrame()
+{
+    shadingFrame = BuildShadingFrame();
+    hasShadingFrame = true;
+}
 
 glm::vec3 IntersectionState::ComputeNormal() const
+{
+    if (hasShadingFrame) {
+        return shadingFrame.normal;
+    }
+    return BuildShadingFrame().normal;
+}
+
+glm::vec2 IntersectionState::ComputeUV() const
+{
+    if (hasShadingFrame) {
+        return shadingFrame.uv;
+    }
+    return BuildShadingFrame().uv;
+}
+
+IntersectionState::ShadingFrame IntersectionState::BuildShadingFrame() const
 {
     assert(hasIntersection && intersectedPrimitive && primitiveParent);
-    assert(primitiveIntersectionWeights.size() == static_cast<size_t>(intersectedPrimitive->GetTotalVertices()));
+    assert(intersectedPrimitive->GetTotalVertices() <= MAXIMUM_PRIMITIVE_VERTICES);
 
-    const glm::mat3 normalTransform = glm::mat3(glm::transpose(glm::inverse(primitiveParent->GetObjectToWorldMatrix())));
+    ShadingFrame frame;
+    for (int i = 0; i < intersectedPrimitive->GetTotalVertices(); ++i) {
+        frame.uv += primitiveIntersectionWeights[i] * intersectedPrimitive->GetVertexUV(i);
+    }
 
+    const glm::mat3 normalTransform = primitiveParent->GetNormalMatrix();
     if (intersectedPrimitive->HasVertexNormals()) {
         // If the mesh has normals, linearly interpolate the normals to get the normal to use.
         glm::vec3 retNormal;
@@ -20,24 +48,35 @@ glm::vec3 IntersectionState::ComputeNormal() const
         }
 
         if (intersectedPrimitive->HasNormalMap()) {
-            return glm::normalize(intersectedPrimitive->GetVertexNormalMap(ComputeUV(), retTangent, retBitangent, retNormal));
+            frame.normal = glm::normalize(intersectedPrimitive->GetVertexNormalMap(frame.uv, retTangent, retBitangent, retNormal));
+        } else {
+            frame.normal = glm::normalize(retNormal);
         }
-
-        return glm::normalize(retNormal);
+        frame.tangent = retTangent;
+    } else {
+        // Otherwise, use the face normal.
+        frame.normal = glm::normalize(normalTransform * intersectedPrimitive->GetPrimitiveNormal());
     }
 
-    // Otherwise, use the face normal.
-    return glm::normalize(normalTransform * intersectedPrimitive->GetPrimitiveNormal());
+    // Gram-Schmidt the tangent against the normal; meshes without usable tangents get an arbitrary one.
+    frame.tangent -= frame.normal * glm::dot(frame.normal, frame.tangent);
+    if (glm::dot(frame.tangent, frame.tangent) < SMALL_EPSILON) {
+        const glm::vec3 helper = (std::abs(frame.normal.x) < 0.9f) ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+        frame.tangent = glm::cross(helper, frame.normal);
+    }
+    frame.tangent = glm::normalize(frame.tangent);
+    frame.bitangent = glm::cross(frame.normal, frame.tangent);
+    return frame;
 }
 
-glm::vec2 IntersectionState::ComputeUV() const
+const Material* IntersectionState::GetMaterial() const
 {
-    assert(hasIntersection && intersectedPrimitive && primitiveParent);
-    assert(primitiveIntersectionWeights.size() == static_cast<size_t>(intersectedPrimitive->GetTotalVertices()));
-
-    glm::vec2 retUV;
-    for (int i = 0; i < intersectedPrimitive->GetTotalVertices(); ++i) {
-        retUV += primitiveIntersectionWeights[i] * intersectedPrimitive->GetVertexUV(i);
+    assert(hasIntersection && intersectedPrimitive);
+    if (primitiveParent && primitiveParent->GetMaterialOverride()) {
+        return primitiveParent->GetMaterialOverride();
     }
-    return retUV;
+
+    const MeshObject* intersectedMesh = intersectedPrimitive->GetParentMeshObject();
+    assert(intersectedMesh);
+    return intersectedMesh->GetMaterial();
 }
\ No newline at end of file
@@ -3,15 +3,23 @@
 #include "common/common.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 
+// Plain hit record: no member owns heap memory, so states can live on the stack or in an IntersectionStateArena and
+// be copied freely.
 struct IntersectionState
 {
+    // Primitives with more vertices than this cannot report their intersection weights.
+    static const int MAXIMUM_PRIMITIVE_VERTICES = 3;
+
     IntersectionState() :
-        reflectionIntersection(nullptr), remainingReflectionBounces(0), refractionIntersection(nullptr), remainingRefractionBounces(0), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f)
+        remainingReflectionBounces(0), remainingRefractionBounces(0), intersectedPrimitive(nullptr), primitiveParent(nullptr), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f), hasShadingFrame(false), arena(nullptr)
     {
     }
 
-    IntersectionState(int reflectionBounces, int refractionBounces) :
-        reflectionIntersection(nullptr), remainingReflectionBounces(reflectionBounces), refractionIntersection(nullptr), remainingRefractionBounces(refractionBounces), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f)
+    // The states of the reflection and refraction rays the renderer traces from this hit (and from those, recursively)
+    // are taken from the arena. Without one, the renderer uses an arena of the calling thread that it resets for
+    // every sample.
+    IntersectionState(int reflectionBounces, int refractionBounces, class IntersectionStateArena* inputArena = nullptr) :
+        remainingReflectionBounces(reflectionBounces), remainingRefractionBounces(refractionBounces), intersectedPrimitive(nullptr), primitiveParent(nullptr), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f), hasShadingFrame(false), arena(inputArena)
     {
     }
 
@@ -26,10 +34,7 @@ struct IntersectionState
         currentIOR = state->currentIOR;
     }
 
-    std::shared_ptr<struct IntersectionState> reflectionIntersection;
     int remainingReflectionBounces;
-
-    std::shared_ptr<struct IntersectionState> refractionIntersection;
     int remainingRefractionBounces;
 
     const class PrimitiveBase* intersectedPrimitive;
@@ -40,9 +45,32 @@ struct IntersectionState
     float currentIOR;
 
     // One for each vertex
-    std::vector<float> primitiveIntersectionWeights;
+    std::array<float, MAXIMUM_PRIMITIVE_VERTICES> primitiveIntersectionWeights;
+
+    // World space frame at the hit point. The tangent and bitangent are orthonormal to the (possibly normal mapped)
+    // normal; they follow the mesh tangents when it has them.
+    struct ShadingFrame
+    {
+        glm::vec3 normal;
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+        glm::vec2 uv;
+    };
+    ShadingFrame shadingFrame;
+    // Set by UpdateShadingFrame(), cleared whenever a primitive stores a new hit.
+    bool hasShadingFrame;
+
+    class IntersectionStateArena* arena;
 
     // Utility Functions
+    // Computes the shading frame of the current hit once, so that shading every light does not have to.
+    void UpdateShadingFrame();
+    // Both use the shading frame when it is there.
     glm::vec3 ComputeNormal() const;
     glm::vec2 ComputeUV() const;
+    // The material of the mesh that was hit, unless the object it belongs to overrides it.
+    const class Material* GetMaterial() const;
+
+private:
+    ShadingFrame BuildShadingFrame() const;
 };
\ No newline at end of file
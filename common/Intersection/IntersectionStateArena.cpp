@@ -0,0 +1,26 @@
+#include "common/Intersection/IntersectionStateArena.h"
+
+const int IntersectionStateArena::BLOCK_SIZE;
+
+IntersectionStateArena::IntersectionStateArena():
+    totalUsed(0)
+{
+}
+
+IntersectionState* IntersectionStateArena::Allocate(int reflectionBounces, int refractionBounces)
+{
+    const int blockIndex = totalUsed / BLOCK_SIZE;
+    if (blockIndex == static_cast<int>(blocks.size())) {
+        blocks.emplace_back(BLOCK_SIZE);
+    }
+
+    IntersectionState* state = &blocks[blockIndex][totalUsed % BLOCK_SIZE];
+    *state = IntersectionState(reflectionBounces, refractionBounces, this);
+    ++totalUsed;
+    return state;
+}
+
+void IntersectionStateArena::Reset()
+{
+    totalUsed = 0;
+}
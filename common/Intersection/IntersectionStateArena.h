@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Intersection/IntersectionState.h"
+
+// Storage for the reflection and refraction states of one camera path. States are handed out in order and only
+// given back all at once by Reset(), which keeps the memory around for the next path. Once the arena has grown to
+// the size of the largest path, tracing no longer allocates. An arena must only be used by one thread.
+class IntersectionStateArena
+{
+public:
+    IntersectionStateArena();
+
+    IntersectionState* Allocate(int reflectionBounces, int refractionBounces);
+    // Invalidates every state handed out so far.
+    void Reset();
+
+private:
+    static const int BLOCK_SIZE = 16;
+
+    // The blocks never change size, so states stay where they are when more blocks get added.
+    std::vector<std::vector<IntersectionState>> blocks;
+    int totalUsed;
+};
@@ -1,5 +1,6 @@
 #include "common/Output/ImageWriter.h"
 #include <locale>
+#include <fstream>
 
 using namespace std;
 
@@ -95,3 +96,45 @@ void ImageWriter::SaveImage()
         m_pOutBitmap = NULL;
     }
 }
+
+HDRBufferStatus ImageWriter::LoadHDRData(const std::string& filename)
+{
+    ifstream input(filename, ios::binary);
+    if (!input) {
+        return HDRBufferStatus::MISSING;
+    }
+
+    int storedWidth = 0;
+    int storedHeight = 0;
+    input.read(reinterpret_cast<char*>(&storedWidth), sizeof(int));
+    input.read(reinterpret_cast<char*>(&storedHeight), sizeof(int));
+    if (!input || storedWidth != mWidth || storedHeight != mHeight) {
+        cerr << "WARNING: HDR buffer " << filename << " does not match the output resolution." << endl;
+        return HDRBufferStatus::UNUSABLE;
+    }
+
+    // Read into a scratch buffer first so that a truncated file does not leave half of it in the image.
+    std::vector<glm::vec3> storedData(static_cast<size_t>(mWidth) * mHeight);
+    input.read(reinterpret_cast<char*>(storedData.data()), sizeof(glm::vec3) * storedData.size());
+    if (!input) {
+        cerr << "WARNING: HDR buffer " << filename << " is truncated." << endl;
+        return HDRBufferStatus::UNUSABLE;
+    }
+
+    std::copy(storedData.begin(), storedData.end(), mHDRData);
+    return HDRBufferStatus::LOADED;
+}
+
+bool ImageWriter::SaveHDRData(const std::string& filename) const
+{
+    ofstream output(filename, ios::binary | ios::trunc);
+    if (!output) {
+        cerr << "WARNING: Could not open HDR buffer " << filename << " for writing." << endl;
+        return false;
+    }
+
+    output.write(reinterpret_cast<const char*>(&mWidth), sizeof(int));
+    output.write(reinterpret_cast<const char*>(&mHeight), sizeof(int));
+    output.write(reinterpret_cast<const char*>(mHDRData), sizeof(glm::vec3) * mWidth * mHeight);
+    return static_cast<bool>(output);
+}
@@ -2,6 +2,14 @@
 
 #include "common/common.h"
 #include "FreeImage.h"
+
+enum class HDRBufferStatus
+{
+    LOADED,
+    MISSING,    // no file yet, it is created when the render finishes
+    UNUSABLE    // the file exists but could not be read (wrong resolution, truncated) and must not be overwritten
+};
+
 // Image Writer Class
 // Use the FreeImage library to write an image to a file
 // Assume (0, 0) is the top left of the image.
@@ -22,6 +30,11 @@ public:
     // Explicit Call to Finish and Save File -- Otherwise done at destructor
     void SaveImage();
 
+    // Raw float dump of the HDR data (width, height, then RGB floats) so that partial renders can be resumed.
+    // The HDR data is only touched if the whole file could be loaded.
+    HDRBufferStatus LoadHDRData(const std::string& filename);
+    bool SaveHDRData(const std::string& filename) const;
+
 private:
     // File name that we want to output to
     std::string m_sFileName;
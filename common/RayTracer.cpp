@@ -3,15 +3,18 @@
 #include "common/Scene/Scene.h"
 #include "common/Scene/Camera/Camera.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
-#include "common/Intersection/IntersectionState.h"
+#include "common/Intersection/IntersectionStateArena.h"
 #include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/RandomSequence.h"
 #include "common/Output/ImageWriter.h"
 #include "common/Rendering/Renderer.h"
-#include "thread"
+#include "common/Scheduling/TileScheduler.h"
 
-#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-#define BOX 1
+#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
 
 
 RayTracer::RayTracer(std::unique_ptr<class Application> app):
@@ -45,56 +48,107 @@ void RayTracer::Run()
     const int maxSamplesPerPixel = storedApplication->GetSamplesPerPixel();
     assert(maxSamplesPerPixel >= 1);
 
-    const unsigned numCPU = std::thread::hardware_concurrency();
-    std::cout << "Number of CPUs: " << numCPU << std::endl;
-
-    // define box which we render (for testing purposes)
-    int row_start = 0;
-    int row_end = static_cast<int>(currentResolution.y);
-    int col_start = 0;
-    int col_end = static_cast<int>(currentResolution.x);
-
-    if (BOX) {
-        row_start = static_cast<int>(currentResolution.y) * 340 / 540 - 50;
-        row_end = static_cast<int>(currentResolution.y) * 340 / 540 + 50;
-        col_start = static_cast<int>(currentResolution.x) * 160 / 960 - 50;
-        col_end = static_cast<int>(currentResolution.x) * 160 / 960 + 50;
+    // Only trace the requested region. Everything outside of it keeps whatever the HDR buffer had in it.
+    glm::ivec2 regionMin;
+    glm::ivec2 regionMax;
+    storedApplication->GetRenderRegion(regionMin, regionMax);
+
+    const std::string hdrBufferFilename = storedApplication->GetHDRBufferFilename();
+    bool writeHDRBuffer = !hdrBufferFilename.empty();
+    if (writeHDRBuffer) {
+        const HDRBufferStatus bufferStatus = imageWriter.LoadHDRData(hdrBufferFilename);
+        if (bufferStatus == HDRBufferStatus::LOADED) {
+            std::cout << "Resuming from HDR buffer " << hdrBufferFilename << std::endl;
+        } else if (bufferStatus == HDRBufferStatus::UNUSABLE) {
+            // Whatever was accumulated in there is worth more than this render, so leave the file alone.
+            std::cerr << "WARNING: Not writing back to HDR buffer " << hdrBufferFilename << "; move it out of the way to start a new one." << std::endl;
+            writeHDRBuffer = false;
+        }
     }
 
-    for (int r = row_start; r < row_end; ++r) {
-        #pragma omp parallel for
-        for (int c = col_start; c < col_end; ++c) {
-            imageWriter.SetPixelColor(currentSampler->ComputeSamplesAndColor(maxSamplesPerPixel, 2, [&](glm::vec3 inputSample, int sampleIdx) {
-                const glm::vec3 minRange(-0.5f, -0.5f, 0.f);
-                const glm::vec3 maxRange(0.5f, 0.5f, 0.f);
-                const glm::vec3 sampleOffset = (maxSamplesPerPixel == 1) ? glm::vec3(0.f, 0.f, 0.f) : minRange + (maxRange - minRange) * inputSample;
-
-                glm::vec2 normalizedCoordinates(static_cast<float>(c) + sampleOffset.x, static_cast<float>(r) + sampleOffset.y);
-                normalizedCoordinates /= currentResolution;
-
-                // Construct ray, send it out into the scene and see what we hit.
-                std::shared_ptr<Ray> cameraRay = currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates);
-                assert(cameraRay);
-
-                IntersectionState rayIntersection(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
-                bool didHitScene = currentScene->Trace(cameraRay.get(), &rayIntersection);
-
-                // Use the intersection data to compute the BRDF response.
-                glm::vec3 sampleColor;
-                if (didHitScene) {
-                    sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, *cameraRay.get(), sampleIdx);
+    const int maxReflectionBounces = storedApplication->GetMaxReflectionBounces();
+    const int maxRefractionBounces = storedApplication->GetMaxRefractionBounces();
+
+#ifdef _OPENMP
+    const int totalThreads = omp_get_max_threads();
+#else
+    const int totalThreads = 1;
+#endif
+    const int totalPasses = std::max(storedApplication->GetProgressivePasses(), 1);
+    for (int pass = 0; pass < totalPasses; ++pass) {
+        TileScheduler scheduler(regionMin.y, regionMax.y, regionMin.x, regionMax.x, storedApplication->GetRenderTileSize(), totalThreads);
+        if (totalPasses > 1) {
+            std::cout << "Pass " << (pass + 1) << " of " << totalPasses << ": ";
+        }
+        std::cout << "Rendering " << scheduler.GetTotalTiles() << " tiles on " << scheduler.GetTotalThreads() << " threads" << std::endl;
+
+        #pragma omp parallel num_threads(totalThreads)
+        {
+#ifdef _OPENMP
+            const int threadIndex = omp_get_thread_num();
+#else
+            const int threadIndex = 0;
+#endif
+            IntersectionStateArena stateArena;
+            TileScheduler::Tile tile;
+            while (scheduler.NextTile(threadIndex, tile)) {
+                for (int r = tile.rowStart; r < tile.rowEnd; ++r) {
+                    for (int c = tile.colStart; c < tile.colEnd; ++c) {
+                        // Random numbers depend on the pixel and sample only, so the image does not change with the
+                        // number of threads or the order the tiles are rendered in.
+                        const uint32_t pixelIndex = static_cast<uint32_t>(r) * static_cast<uint32_t>(currentResolution.x) + static_cast<uint32_t>(c);
+                        RandomSequence::BeginPixel(pixelIndex, static_cast<uint32_t>(pass * maxSamplesPerPixel));
+
+                        const glm::vec3 passColor = currentSampler->ComputeSamplesAndColor(maxSamplesPerPixel, 2, [&](glm::vec3 inputSample, int sampleIdx) {
+                            const glm::vec3 minRange(-0.5f, -0.5f, 0.f);
+                            const glm::vec3 maxRange(0.5f, 0.5f, 0.f);
+                            const glm::vec3 sampleOffset = (maxSamplesPerPixel == 1) ? glm::vec3(0.f, 0.f, 0.f) : minRange + (maxRange - minRange) * inputSample;
+
+                            glm::vec2 normalizedCoordinates(static_cast<float>(c) + sampleOffset.x, static_cast<float>(r) + sampleOffset.y);
+                            normalizedCoordinates /= currentResolution;
+
+                            // Construct ray, send it out into the scene and see what we hit.
+                            Ray cameraRay = currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates);
+
+                            // The secondary states of the previous sample are no longer needed.
+                            stateArena.Reset();
+                            IntersectionState rayIntersection(maxReflectionBounces, maxRefractionBounces, &stateArena);
+                            bool didHitScene = currentScene->Trace(&cameraRay, &rayIntersection);
+
+                            // Use the intersection data to compute the BRDF response.
+                            glm::vec3 sampleColor;
+                            if (didHitScene) {
+                                sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, cameraRay, sampleIdx);
+                            }
+
+                            // perform gamma - correction
+                            sampleColor = glm::pow(sampleColor, glm::vec3(1.f, 1.f, 1.f) * 1.0f / 2.2f);
+
+                            return sampleColor;
+                        });
+
+                        // Running average over the passes; the first pass replaces what the HDR buffer had.
+                        if (pass == 0) {
+                            imageWriter.SetPixelColor(passColor, c, r);
+                        } else {
+                            const glm::vec3 previousColor = imageWriter.GetHDRPixelColor(c, r);
+                            imageWriter.SetPixelColor(previousColor + (passColor - previousColor) / static_cast<float>(pass + 1), c, r);
+                        }
+                    }
                 }
+                scheduler.NotifyTileFinished(threadIndex, tile);
+            }
+        }
+        scheduler.PrintStatistics();
 
-                // perform gamma - correction
-                sampleColor = glm::pow(sampleColor, glm::vec3(1.f, 1.f, 1.f) * 1.0f / 2.2f);
-
-                return sampleColor;
-            }), c, r);
-//            if ((r < float(currentResolution.y) / numCPU) && ((c % 100) == 0)) {
-//                std::cout << (r + c / currentResolution.x) / currentResolution.y * numCPU * 100.0f << " % finished..." << std::endl;
-//            }
+        if (writeHDRBuffer && pass + 1 < totalPasses) {
+            imageWriter.SaveHDRData(hdrBufferFilename);
         }
-         std::cout << "Row " << r << " of " << currentResolution.y << " finished..." << std::endl;
+    }
+
+    // Store the raw result before post-processing touches it so that later region renders can be merged in.
+    if (writeHDRBuffer) {
+        imageWriter.SaveHDRData(hdrBufferFilename);
     }
 
     // Apply post-processing steps (i.e. tone-mapper, etc.).
@@ -23,9 +23,7 @@ Texture* Material::GetTexture(const std::string& id) const
 
 glm::vec3 Material::ComputeNonLightDependentBRDF(const class Renderer* renderer, const struct IntersectionState& intersection) const
 {
-    const glm::vec3 reflectionColor = ComputeReflection(renderer, intersection);
-    const glm::vec3 transmissionColor = ComputeTransmission(renderer, intersection);
-    return reflectivity * reflectionColor + transmittance * transmissionColor + ambient;
+    return ambient;
 }
 
 glm::vec3 Material::ComputeBRDF(const struct IntersectionState& intersection, const glm::vec3& lightColor, const class Ray& toLightRay, const class Ray& fromCameraRay, float lightAttenuation, bool computeDiffuse, bool computeSpecular) const
@@ -57,24 +55,6 @@ glm::vec3 Material::ComputeSpecular(const struct IntersectionState& intersection
     return glm::vec3();
 }
 
-glm::vec3 Material::ComputeReflection(const class Renderer* renderer, const struct IntersectionState& intersection) const
-{
-    glm::vec3 reflectedColor;
-    if (intersection.reflectionIntersection && intersection.reflectionIntersection->hasIntersection) {
-        reflectedColor = renderer->ComputeSampleColor(*intersection.reflectionIntersection.get(), intersection.reflectionIntersection->intersectionRay, 10);
-    }
-    return reflectedColor;
-}
-
-glm::vec3 Material::ComputeTransmission(const class Renderer* renderer, const struct IntersectionState& intersection) const
-{
-    glm::vec3 transmissionColor;
-    if (intersection.refractionIntersection && intersection.refractionIntersection->hasIntersection) {
-        transmissionColor = renderer->ComputeSampleColor(*intersection.refractionIntersection.get(), intersection.refractionIntersection->intersectionRay, 10);
-    }
-    return transmissionColor;
-}
-
 void Material::SetReflectivity(float input)
 {
     reflectivity = input;
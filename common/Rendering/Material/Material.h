@@ -8,6 +8,8 @@ public:
     Material();
     virtual ~Material();
 
+    // Everything but the direct lighting. Reflection and refraction are traced by the renderer, which weighs them
+    // with GetReflectivity() and GetBaseTransmittance().
     virtual glm::vec3 ComputeNonLightDependentBRDF(const class Renderer* renderer, const struct IntersectionState& intersection) const;
     virtual glm::vec3 ComputeBRDF(const struct IntersectionState& intersection, const glm::vec3& lightColor, const class Ray& toLightRay, const class Ray& fromCameraRay, float lightAttenuation, bool computeDiffuse = true, bool computeSpecular = true) const;
     
@@ -19,6 +21,7 @@ public:
 
     void SetReflectivity(float input);
     bool IsReflective() const { return reflectivity > SMALL_EPSILON; }
+    float GetReflectivity() const { return reflectivity; }
 
     void SetTransmittance(float input);
     bool IsTransmissive() const { return transmittance > SMALL_EPSILON; }
@@ -39,8 +42,6 @@ public:
 protected:
     virtual glm::vec3 ComputeDiffuse(const struct IntersectionState& intersection, const glm::vec3& lightColor, const float NdL, const float NdH, const float NdV, const float VdH) const;
     virtual glm::vec3 ComputeSpecular(const struct IntersectionState& intersection, const glm::vec3& lightColor, const float NdL, const float NdH, const float NdV, const float VdH) const;
-    virtual glm::vec3 ComputeReflection(const class Renderer* renderer, const struct IntersectionState& intersection) const;
-    virtual glm::vec3 ComputeTransmission(const class Renderer* renderer, const struct IntersectionState& intersection) const;
 
     std::unordered_map<std::string, std::shared_ptr<class Texture>> textureStorage;
 private:
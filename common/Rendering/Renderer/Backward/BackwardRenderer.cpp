@@ -1,14 +1,29 @@
 #include "common/Rendering/Renderer/Backward/BackwardRenderer.h"
 #include "common/Scene/Scene.h"
 #include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/RandomSequence.h"
 #include "common/Scene/Lights/Light.h"
 #include "common/Scene/Geometry/Primitives/Primitive.h"
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
 #include "common/Intersection/IntersectionState.h"
+#include "common/Intersection/IntersectionStateArena.h"
+
+namespace
+{
+    const int LOCAL_PATH_STACK_SIZE = 32;
+
+    // A hit whose color still has to be added, together with the weight it reaches the camera with.
+    struct PathVertex
+    {
+        const IntersectionState* state;
+        const Ray* fromRay;
+        glm::vec3 throughput;
+    };
+}
 
 BackwardRenderer::BackwardRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) :
-    Renderer(scene, sampler)
+    Renderer(scene, sampler), russianRouletteThreshold(0.1f), lightSampleCount(4)
 {
 }
 
@@ -16,23 +31,111 @@ void BackwardRenderer::InitializeRenderer()
 {
 }
 
+void BackwardRenderer::SetRussianRouletteThreshold(float input)
+{
+    russianRouletteThreshold = input;
+}
+
+void BackwardRenderer::SetLightSampleCount(int input)
+{
+    lightSampleCount = input;
+}
+
 glm::vec3 BackwardRenderer::ComputeSampleColor(const IntersectionState& intersection, const Ray& fromCameraRay, int sampleIdx) const
 {
     if (!intersection.hasIntersection) {
         return glm::vec3();
     }
 
-    glm::vec3 intersectionPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
-    const MeshObject* parentObject = intersection.intersectedPrimitive->GetParentMeshObject();
-    assert(parentObject);
+    // Reflection and refraction states come from the arena of the camera path, or from one of this thread.
+    IntersectionStateArena* arena = intersection.arena;
+    if (!arena) {
+        thread_local IntersectionStateArena threadArena;
+        threadArena.Reset();
+        arena = &threadArena;
+    }
+
+    // Every vertex pushes at most two branches and each of them uses up a bounce, so the stack never holds more
+    // than the bounce budget of the first hit plus one vertex.
+    PathVertex localStack[LOCAL_PATH_STACK_SIZE];
+    std::vector<PathVertex> overflowStack;
+    PathVertex* pathStack = localStack;
+    const int maximumStackSize = intersection.remainingReflectionBounces + intersection.remainingRefractionBounces + 1;
+    if (maximumStackSize > LOCAL_PATH_STACK_SIZE) {
+        overflowStack.resize(maximumStackSize);
+        pathStack = overflowStack.data();
+    }
+
+    int stackSize = 0;
+    pathStack[stackSize++] = PathVertex{ &intersection, &fromCameraRay, glm::vec3(1.f) };
+
+    glm::vec3 sampleColor;
+    while (stackSize > 0) {
+        const PathVertex vertex = pathStack[--stackSize];
+        const IntersectionState& state = *vertex.state;
+        sampleColor += vertex.throughput * ComputeLocalColor(state, *vertex.fromRay);
+
+        const Material* objectMaterial = state.GetMaterial();
+        const glm::vec3 intersectionPoint = state.intersectionRay.GetRayPosition(state.intersectionT);
+        const float NdR = glm::dot(state.intersectionRay.GetRayDirection(), state.ComputeNormal());
+
+        // Secondary rays are only traced once we know that they are worth something.
+        glm::vec3 reflectionThroughput = vertex.throughput * glm::vec3(objectMaterial->GetReflectivity());
+        if (objectMaterial->IsReflective() && state.remainingReflectionBounces > 0 && ContinueBranch(reflectionThroughput)) {
+            IntersectionState* reflectionState = arena->Allocate(state.remainingReflectionBounces - 1, state.remainingRefractionBounces);
+
+            Ray reflectionRay;
+            storedScene->PerformRaySpecularReflection(reflectionRay, state.intersectionRay, intersectionPoint, NdR, state);
+            if (storedScene->Trace(&reflectionRay, reflectionState)) {
+                pathStack[stackSize++] = PathVertex{ reflectionState, &reflectionState->intersectionRay, reflectionThroughput };
+            }
+        }
 
-    const Material* objectMaterial = parentObject->GetMaterial();
+        glm::vec3 refractionThroughput = vertex.throughput * objectMaterial->GetBaseTransmittance();
+        if (objectMaterial->IsTransmissive() && state.remainingRefractionBounces > 0 && ContinueBranch(refractionThroughput)) {
+            IntersectionState* refractionState = arena->Allocate(state.remainingReflectionBounces, state.remainingRefractionBounces - 1);
+
+            // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
+            float targetIOR = (NdR < SMALL_EPSILON) ? objectMaterial->GetIOR() : 1.f;
+
+            Ray refractionRay;
+            storedScene->PerformRayRefraction(refractionRay, state.intersectionRay, intersectionPoint, NdR, state, targetIOR);
+            refractionState->currentIOR = targetIOR;
+            if (storedScene->Trace(&refractionRay, refractionState)) {
+                pathStack[stackSize++] = PathVertex{ refractionState, &refractionState->intersectionRay, refractionThroughput };
+            }
+        }
+    }
+    return sampleColor;
+}
+
+glm::vec3 BackwardRenderer::ComputeLocalColor(const IntersectionState& intersection, const Ray& fromRay) const
+{
+    glm::vec3 intersectionPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+    const Material* objectMaterial = intersection.GetMaterial();
     assert(objectMaterial);
 
     // Compute the color at the intersection.
+    // With more lights than we want to shade, pick them by power. The picks are stratified over [0, 1) so that
+    // the strong lights are not picked over and over again.
+    const int totalLights = static_cast<int>(storedScene->GetTotalLights());
+    const bool pickLights = (lightSampleCount > 0 && lightSampleCount < totalLights);
+    const int lightsToShade = pickLights ? lightSampleCount : totalLights;
+    const float stratumOffset = pickLights ? RandomSequence::NextFloat() : 0.f;
+
     glm::vec3 sampleColor;
-    for (size_t i = 0; i < storedScene->GetTotalLights(); ++i) {
-        const Light* light = storedScene->GetLightObject(i);
+    for (int i = 0; i < lightsToShade; ++i) {
+        int lightIndex = i;
+        float lightWeight = 1.f;
+        if (pickLights) {
+            float selectionProbability = 1.f;
+            lightIndex = storedScene->SampleLight((static_cast<float>(i) + stratumOffset) / static_cast<float>(lightsToShade), selectionProbability);
+            if (selectionProbability <= 0.f) {
+                continue;
+            }
+            lightWeight = 1.f / (static_cast<float>(lightsToShade) * selectionProbability);
+        }
+        const Light* light = storedScene->GetLightObject(static_cast<size_t>(lightIndex));
         assert(light);
 
         // Sample light using rays, Number of samples and where to sample is determined by the light.
@@ -41,16 +144,34 @@ glm::vec3 BackwardRenderer::ComputeSampleColor(const IntersectionState& intersec
 
         for (size_t s = 0; s < sampleRays.size(); ++s) {
             // note that max T should be set to be right before the light.
-            if (storedScene->Trace(&sampleRays[s], nullptr)) {
+            if (storedScene->Occluded(&sampleRays[s])) {
                 continue;
             }
-            const float lightAttenuation = light->ComputeLightAttenuation(intersectionPoint);
+            const float lightAttenuation = light->ComputeLightAttenuation(intersectionPoint) * lightWeight;
 
             // Note that the material should compute the parts of the lighting equation too.
-            const glm::vec3 brdfResponse = objectMaterial->ComputeBRDF(intersection, light->GetLightColor(), sampleRays[s], fromCameraRay, lightAttenuation);
+            const glm::vec3 brdfResponse = objectMaterial->ComputeBRDF(intersection, light->GetLightColor(), sampleRays[s], fromRay, lightAttenuation);
             sampleColor += brdfResponse;
         }
     }
     sampleColor += objectMaterial->ComputeNonLightDependentBRDF(this, intersection);
     return sampleColor;
 }
+
+bool BackwardRenderer::ContinueBranch(glm::vec3& throughput) const
+{
+    const float weight = std::max(throughput.x, std::max(throughput.y, throughput.z));
+    if (weight <= 0.f) {
+        return false;
+    }
+    if (weight >= russianRouletteThreshold) {
+        return true;
+    }
+
+    const float survivalProbability = weight / russianRouletteThreshold;
+    if (RandomSequence::NextFloat() >= survivalProbability) {
+        return false;
+    }
+    throughput /= survivalProbability;
+    return true;
+}
@@ -8,4 +8,25 @@ public:
     BackwardRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler);
     virtual void InitializeRenderer() override;
     glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay, int sampleIdx) const override;
+
+    // Reflection and refraction branches whose weight (the largest channel of the product of all reflectivities and
+    // transmittances up to the camera) drops below this are continued with probability weight / threshold and
+    // scaled up to make up for it. Zero follows every branch until the bounce limits.
+    void SetRussianRouletteThreshold(float input);
+
+    // Every hit shades this many lights, picked with probability proportional to their power (see Scene::SampleLight)
+    // and weighed up to make up for the ones that were skipped. Scenes with at most this many lights, or a count of
+    // zero, shade every light.
+    void SetLightSampleCount(int input);
+
+protected:
+    // Direct lighting and ambient term at a single hit, as seen along fromRay.
+    glm::vec3 ComputeLocalColor(const struct IntersectionState& intersection, const class Ray& fromRay) const;
+
+private:
+    // Returns false if the branch should be dropped; otherwise throughput may have been scaled up.
+    bool ContinueBranch(glm::vec3& throughput) const;
+
+    float russianRouletteThreshold;
+    int lightSampleCount;
 };
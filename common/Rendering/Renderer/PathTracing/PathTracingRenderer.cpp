@@ -0,0 +1,228 @@
+#include "common/Rendering/Renderer/PathTracing/PathTracingRenderer.h"
+#include "common/Scene/Scene.h"
+#include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/RandomSequence.h"
+#include "common/Scene/Lights/Light.h"
+#include "common/Rendering/Material/Material.h"
+#include "common/Intersection/IntersectionState.h"
+
+namespace
+{
+    float MaxComponent(const glm::vec3& input)
+    {
+        return std::max(input.x, std::max(input.y, input.z));
+    }
+
+    // Power heuristic (beta = 2) for the strategy that produced pdf, against the other one.
+    float PowerHeuristic(float pdf, float otherPdf)
+    {
+        const float pdf2 = pdf * pdf;
+        const float otherPdf2 = otherPdf * otherPdf;
+        return (pdf2 + otherPdf2 > 0.f) ? pdf2 / (pdf2 + otherPdf2) : 0.f;
+    }
+
+    enum class PathBounce
+    {
+        SURFACE,
+        MIRROR,
+        TRANSMISSION
+    };
+}
+
+PathTracingRenderer::PathTracingRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) :
+    Renderer(scene, sampler), russianRouletteStartBounce(3), lightSampleCount(1)
+{
+}
+
+void PathTracingRenderer::InitializeRenderer()
+{
+}
+
+void PathTracingRenderer::SetRussianRouletteStartBounce(int input)
+{
+    russianRouletteStartBounce = input;
+}
+
+void PathTracingRenderer::SetLightSampleCount(int input)
+{
+    lightSampleCount = input;
+}
+
+float PathTracingRenderer::ComputeLightSelectionScale(size_t lightIndex) const
+{
+    const size_t totalLights = storedScene->GetTotalLights();
+    if (lightSampleCount <= 0 || static_cast<size_t>(lightSampleCount) >= totalLights) {
+        return 1.f;
+    }
+    return static_cast<float>(lightSampleCount) * storedScene->GetLightSelectionProbability(lightIndex);
+}
+
+glm::vec3 PathTracingRenderer::ComputeSampleColor(const IntersectionState& intersection, const Ray& fromCameraRay, int sampleIdx) const
+{
+    if (!intersection.hasIntersection) {
+        return glm::vec3();
+    }
+
+    IntersectionState state = intersection;
+    Ray fromRay = fromCameraRay;
+    glm::vec3 throughput(1.f);
+    glm::vec3 sampleColor;
+    for (int bounce = 0; ; ++bounce) {
+        if (!state.hasShadingFrame) {
+            state.UpdateShadingFrame();
+        }
+        const Material* objectMaterial = state.GetMaterial();
+        assert(objectMaterial);
+        sampleColor += throughput * objectMaterial->ComputeNonLightDependentBRDF(this, state);
+
+        const glm::vec3 intersectionPoint = state.intersectionRay.GetRayPosition(state.intersectionT);
+        const IntersectionState::ShadingFrame& frame = state.shadingFrame;
+        const float NdR = glm::dot(state.intersectionRay.GetRayDirection(), frame.normal);
+
+        // Selection weights of the ways to continue. ComputeBRDF already scales the diffuse and glossy part down by
+        // the reflectivity and transmittance, so the three weights add up to at most one.
+        const float surfaceWeight = std::max(1.f - objectMaterial->GetReflectivity() - objectMaterial->GetTransmittance(), 0.f);
+        const glm::vec3 mirrorWeight = objectMaterial->IsReflective() ? glm::vec3(objectMaterial->GetReflectivity()) : glm::vec3();
+        const glm::vec3 transmissionWeight = objectMaterial->IsTransmissive() ? objectMaterial->GetBaseTransmittance() : glm::vec3();
+
+        float surfaceProbability = (state.remainingReflectionBounces > 0) ? surfaceWeight : 0.f;
+        float mirrorProbability = (state.remainingReflectionBounces > 0) ? MaxComponent(mirrorWeight) : 0.f;
+        float transmissionProbability = (state.remainingRefractionBounces > 0) ? MaxComponent(transmissionWeight) : 0.f;
+        const float totalProbability = surfaceProbability + mirrorProbability + transmissionProbability;
+        if (totalProbability > 0.f) {
+            surfaceProbability /= totalProbability;
+            mirrorProbability /= totalProbability;
+            transmissionProbability /= totalProbability;
+        }
+
+        // Direct lighting does not need a bounce, so the last hit of a path still gets it.
+        if (surfaceWeight > 0.f) {
+            sampleColor += throughput * ComputeDirectLighting(state, fromRay, intersectionPoint + frame.normal * LARGE_EPSILON, surfaceProbability);
+        }
+
+        if (totalProbability <= 0.f) {
+            break;
+        }
+        if (bounce >= russianRouletteStartBounce) {
+            const float survivalProbability = std::min(MaxComponent(throughput), 1.f);
+            if (RandomSequence::NextFloat() >= survivalProbability) {
+                break;
+            }
+            throughput /= survivalProbability;
+        }
+
+        const float lobeSample = RandomSequence::NextFloat();
+        const PathBounce pathBounce = (lobeSample < surfaceProbability) ? PathBounce::SURFACE : ((lobeSample < surfaceProbability + mirrorProbability) ? PathBounce::MIRROR : PathBounce::TRANSMISSION);
+
+        Ray nextRay;
+        IntersectionState nextState(state.remainingReflectionBounces, state.remainingRefractionBounces, state.arena);
+        nextState.currentIOR = state.currentIOR;
+        // Solid angle density of the next direction for weighing light hits, zero if it can not be sampled from the lights.
+        float bouncePdf = 0.f;
+        if (pathBounce == PathBounce::SURFACE) {
+            // Cosine weighted direction around the shading normal.
+            const float u = RandomSequence::NextFloat();
+            const float phi = 2.f * PI * RandomSequence::NextFloat();
+            const float sinTheta = std::sqrt(u);
+            const float cosTheta = std::sqrt(std::max(1.f - u, 0.f));
+            const glm::vec3 bounceDirection = glm::normalize(sinTheta * std::cos(phi) * frame.tangent + sinTheta * std::sin(phi) * frame.bitangent + cosTheta * frame.normal);
+            if (cosTheta < SMALL_EPSILON) {
+                break;
+            }
+            nextRay.SetRayPosition(intersectionPoint + LARGE_EPSILON * bounceDirection);
+            nextRay.SetRayDirection(bounceDirection);
+
+            // ComputeBRDF includes the cosine and is PI times the BRDF of a white diffuse surface.
+            bouncePdf = surfaceProbability * cosTheta / PI;
+            throughput *= objectMaterial->ComputeBRDF(state, glm::vec3(1.f), nextRay, fromRay, 1.f) / (PI * bouncePdf);
+            --nextState.remainingReflectionBounces;
+        } else if (pathBounce == PathBounce::MIRROR) {
+            storedScene->PerformRaySpecularReflection(nextRay, state.intersectionRay, intersectionPoint, NdR, state);
+            throughput *= mirrorWeight / mirrorProbability;
+            --nextState.remainingReflectionBounces;
+        } else {
+            // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
+            float targetIOR = (NdR < SMALL_EPSILON) ? objectMaterial->GetIOR() : 1.f;
+            storedScene->PerformRayRefraction(nextRay, state.intersectionRay, intersectionPoint, NdR, state, targetIOR);
+            nextState.currentIOR = targetIOR;
+            throughput *= transmissionWeight / transmissionProbability;
+            --nextState.remainingRefractionBounces;
+        }
+        if (MaxComponent(throughput) <= 0.f) {
+            break;
+        }
+
+        const glm::vec3 rayOrigin = glm::vec3(nextRay.GetPosition());
+        const glm::vec3 rayDirection = nextRay.GetRayDirection();
+        const bool didHitScene = storedScene->Trace(&nextRay, &nextState);
+
+        // Lights the ray passes before it hits the scene. Lights are not part of the scene, so they do not stop it.
+        const float sceneDistance = didHitScene ? nextState.intersectionT : std::numeric_limits<float>::max();
+        for (size_t i = 0; i < storedScene->GetTotalLights(); ++i) {
+            const Light* light = storedScene->GetLightObject(i);
+            float lightDistance = 0.f;
+            float lightPdf = 0.f;
+            glm::vec3 lightRadiance;
+            if (!light->IntersectLight(rayOrigin, rayDirection, sceneDistance, lightDistance, lightRadiance, lightPdf)) {
+                continue;
+            }
+            // Mirror and refraction directions can not be sampled from the lights, so next event estimation never covers them.
+            const float misWeight = (bouncePdf > 0.f) ? PowerHeuristic(bouncePdf, ComputeLightSelectionScale(i) * lightPdf) : 1.f;
+            sampleColor += throughput * lightRadiance * misWeight;
+        }
+
+        if (!didHitScene) {
+            break;
+        }
+        state = nextState;
+        fromRay = nextState.intersectionRay;
+    }
+    return sampleColor;
+}
+
+glm::vec3 PathTracingRenderer::ComputeDirectLighting(const IntersectionState& intersection, const Ray& fromRay, const glm::vec3& origin, float surfaceProbability) const
+{
+    const Material* objectMaterial = intersection.GetMaterial();
+    const glm::vec3 normal = intersection.ComputeNormal();
+
+    // Stratified picks by power when there are more lights than we want to sample.
+    const int totalLights = static_cast<int>(storedScene->GetTotalLights());
+    const bool pickLights = (lightSampleCount > 0 && lightSampleCount < totalLights);
+    const int lightsToSample = pickLights ? lightSampleCount : totalLights;
+    const float stratumOffset = pickLights ? RandomSequence::NextFloat() : 0.f;
+
+    glm::vec3 directColor;
+    for (int i = 0; i < lightsToSample; ++i) {
+        int lightIndex = i;
+        float selectionScale = 1.f;
+        if (pickLights) {
+            float selectionProbability = 1.f;
+            lightIndex = storedScene->SampleLight((static_cast<float>(i) + stratumOffset) / static_cast<float>(lightsToSample), selectionProbability);
+            selectionScale = static_cast<float>(lightsToSample) * selectionProbability;
+            if (selectionScale <= 0.f) {
+                continue;
+            }
+        }
+        const Light* light = storedScene->GetLightObject(static_cast<size_t>(lightIndex));
+        assert(light);
+
+        LightSample lightSample;
+        const float u = RandomSequence::NextFloat();
+        if (!light->SampleLight(origin, glm::vec2(u, RandomSequence::NextFloat()), lightSample)) {
+            continue;
+        }
+
+        Ray shadowRay(origin, lightSample.direction, lightSample.distance);
+        if (storedScene->Occluded(&shadowRay)) {
+            continue;
+        }
+
+        glm::vec3 brdfResponse = objectMaterial->ComputeBRDF(intersection, lightSample.contribution, shadowRay, fromRay, 1.f / selectionScale);
+        if (lightSample.pdf > 0.f) {
+            const float bouncePdf = surfaceProbability * std::max(glm::dot(normal, lightSample.direction), 0.f) / PI;
+            brdfResponse *= PowerHeuristic(selectionScale * lightSample.pdf, bouncePdf);
+        }
+        directColor += brdfResponse;
+    }
+    return directColor;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/Rendering/Renderer.h"
+
+// Unidirectional path tracer: every sample follows a single path from the camera. At each hit the path picks one way
+// to continue (the diffuse and glossy part of the material, the mirror reflection or the refraction) with a probability
+// proportional to its weight. Lights are sampled directly at every hit (next event estimation) and also picked up when
+// a diffuse or glossy bounce happens to hit them; the two estimates are combined with multiple importance sampling.
+//
+// Lights keep the units the BackwardRenderer uses, so both renderers agree on direct lighting. The ambient term of a
+// material is treated as light emitted by the surface. Lights are not visible to camera rays.
+class PathTracingRenderer : public Renderer
+{
+public:
+    PathTracingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler);
+    virtual void InitializeRenderer() override;
+    glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay, int sampleIdx) const override;
+
+    // From this many bounces on, a path survives each further bounce with probability equal to the largest channel
+    // of its throughput (at most one) and is scaled up to make up for it. The bounce limits of the intersection
+    // states still apply.
+    void SetRussianRouletteStartBounce(int input);
+
+    // Lights sampled at every hit, picked with probability proportional to their power (see Scene::SampleLight).
+    // Scenes with at most this many lights, or a count of zero, sample every light.
+    void SetLightSampleCount(int input);
+
+private:
+    // Next event estimation for the diffuse and glossy part of the material. surfaceProbability is the chance that
+    // the path continues with a diffuse or glossy bounce from here, which the light samples are weighed against.
+    glm::vec3 ComputeDirectLighting(const struct IntersectionState& intersection, const class Ray& fromRay, const glm::vec3& origin, float surfaceProbability) const;
+
+    // How many times as likely next event estimation is to produce a direction towards the given light than the
+    // light's own pdf says, given how the lights are picked.
+    float ComputeLightSelectionScale(size_t lightIndex) const;
+
+    int russianRouletteStartBounce;
+    int lightSampleCount;
+};
@@ -1,6 +1,7 @@
 #include "common/Rendering/Renderer/Photon/PhotonMappingRenderer.h"
 #include "common/Scene/Scene.h"
 #include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/RandomSequence.h"
 #include "common/Scene/Lights/Light.h"
 #include "common/Scene/Geometry/Primitives/Primitive.h"
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
@@ -21,7 +22,6 @@ PhotonMappingRenderer::PhotonMappingRenderer(std::shared_ptr<class Scene> scene,
     minPhotonBounces(1), // normal is one: only don't count the first direct hit (= zero bounces)
     targetPhotonCount(10)
 {
-    srand(static_cast<unsigned int>(time(NULL)));
 }
 
 void PhotonMappingRenderer::InitializeRenderer()
@@ -62,6 +62,8 @@ void PhotonMappingRenderer::GenericPhotonMapGeneration(PhotonKdtree& photonMap,
     }
 
     // Shoot photons -- number of photons for light is proportional to the light's intensity relative to the total light intensity of the scene.
+    // Every photon gets its own random numbers, keyed by how many photons were shot before it.
+    uint32_t firstPhotonIndex = 0;
     while (photonMap.size() < targetPhotonCount){
         for (size_t i = 0; i < totalLights; ++i) {
             const Light* currentLight = storedScene->GetLightObject(i);
@@ -78,9 +80,11 @@ void PhotonMappingRenderer::GenericPhotonMapGeneration(PhotonKdtree& photonMap,
                 Ray photonRay;
                 int path;
                 path = 1;
+                RandomSequence::BeginPhoton(firstPhotonIndex + static_cast<uint32_t>(j));
                 currentLight->GenerateRandomPhotonRay(photonRay);
                 TracePhoton(photonMap, &photonRay, photonIntensity, path, 1.f, maxPhotonBounces);
             }
+            firstPhotonIndex += static_cast<uint32_t>(totalPhotonsForLight);
         }
     }
 }
@@ -139,20 +143,19 @@ void PhotonMappingRenderer::TracePhoton(PhotonKdtree& photonMap, Ray* photonRay,
     }
 
     // get the material that we hit to determine reflection or absorption
-    const MeshObject* hitMeshObject = state.intersectedPrimitive->GetParentMeshObject();
-    const Material* hitMaterial = hitMeshObject->GetMaterial();
+    const Material* hitMaterial = state.GetMaterial();
 
     // get the diffuse reflection of the material and calculate reflection probablilty
     const glm::vec3 diffuseReflection = hitMaterial->GetBaseDiffuseReflection();
     const float Pr = glm::max(glm::max(diffuseReflection.x, diffuseReflection.y), diffuseReflection.z);
 
     // generate random number to see whether we relfect or absorb
-    const float thresh = (float)std::rand()/RAND_MAX;
+    const float thresh = RandomSequence::NextFloat();
     if (thresh < Pr){
         // scatter photon (for diffuese: in random direction)
         // generate two random numbers for the direction of the scattered ray (sample on disk and transform to hemisphere)
-        const float u1 = (float)std::rand()/RAND_MAX;
-        const float u2 = (float)std::rand()/RAND_MAX;
+        const float u1 = RandomSequence::NextFloat();
+        const float u2 = RandomSequence::NextFloat();
 
         const float r = std::sqrt(u1);
         const float theta = 2.f*PI*u2;
@@ -219,8 +222,7 @@ glm::vec3 PhotonMappingRenderer::ComputeSampleColor(const struct IntersectionSta
     Photon intersectionVirtualPhoton;
     intersectionVirtualPhoton.position = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
 
-    const MeshObject* intersectionMeshObject = intersection.intersectedPrimitive->GetParentMeshObject();
-    const Material* intersectionMaterial = intersectionMeshObject->GetMaterial();
+    const Material* intersectionMaterial = intersection.GetMaterial();
 
     // find photons that are near the intersection (within constant radius)
     std::vector<Photon> foundPhotons;
@@ -235,8 +237,7 @@ glm::vec3 PhotonMappingRenderer::ComputeSampleColor(const struct IntersectionSta
     Photon intersectionVirtualPhoton;
     intersectionVirtualPhoton.position = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
 
-    const MeshObject* intersectionMeshObject = intersection.intersectedPrimitive->GetParentMeshObject();
-    const Material* intersectionMaterial = intersectionMeshObject->GetMaterial();
+    const Material* intersectionMaterial = intersection.GetMaterial();
 
     // find photons that are near the intersection (within constant radius)
     std::vector<Photon> foundPhotons;
@@ -5,10 +5,10 @@ SimpleAdaptiveSampler::SimpleAdaptiveSampler() :
 {
 }
 
-std::unique_ptr<SamplerState> SimpleAdaptiveSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+std::unique_ptr<SamplerState> SimpleAdaptiveSampler::CreateSampler(const int maxSamples, const int dimensions) const
 {
-    std::unique_ptr<SimpleAdaptiveSamplerState> state = make_unique<SimpleAdaptiveSamplerState>(randomDevice, maxSamples, dimensions);
-    state->internalState = internalSampler->CreateSampler(randomDevice, maxSamples, dimensions);
+    std::unique_ptr<SimpleAdaptiveSamplerState> state = make_unique<SimpleAdaptiveSamplerState>(maxSamples, dimensions);
+    state->internalState = internalSampler->CreateSampler(maxSamples, dimensions);
     return std::move(state);
 }
 
@@ -4,8 +4,8 @@
 
 struct SimpleAdaptiveSamplerState : public SamplerState
 {
-    SimpleAdaptiveSamplerState(std::random_device& device, int inputMax, int inputDim) :
-        SamplerState(device, inputMax, inputDim)
+    SimpleAdaptiveSamplerState(int inputMax, int inputDim) :
+        SamplerState(inputMax, inputDim)
     {
     }
 
@@ -19,7 +19,7 @@ public:
     void SetInternalSampler(std::shared_ptr<ColorSampler> inputSampler);
     void SetEarlyExitParameters(float threshold, int minSampleCount);
 
-    virtual std::unique_ptr<SamplerState> CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const override;
+    virtual std::unique_ptr<SamplerState> CreateSampler(const int maxSamples, const int dimensions) const override;
     virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
 
     virtual void InitializeSampler(class Application* app, class Scene* inputScene) override;
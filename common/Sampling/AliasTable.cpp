@@ -0,0 +1,58 @@
+#include "common/Sampling/AliasTable.h"
+
+void AliasTable::Build(const std::vector<float>& weights)
+{
+    const int totalItems = static_cast<int>(weights.size());
+    thresholds.assign(totalItems, 1.f);
+    aliases.resize(totalItems);
+    probabilities.resize(totalItems);
+
+    double totalWeight = 0.0;
+    for (int i = 0; i < totalItems; ++i) {
+        totalWeight += std::max(weights[i], 0.f);
+    }
+    for (int i = 0; i < totalItems; ++i) {
+        probabilities[i] = (totalWeight > 0.0) ? static_cast<float>(std::max(weights[i], 0.f) / totalWeight) : 1.f / static_cast<float>(totalItems);
+        aliases[i] = i;
+    }
+
+    // Columns below the average get topped up by one that is above it, which then moves down by the same amount.
+    std::vector<double> scaled(totalItems);
+    std::vector<int> small;
+    std::vector<int> large;
+    for (int i = 0; i < totalItems; ++i) {
+        scaled[i] = static_cast<double>(probabilities[i]) * totalItems;
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+    while (!small.empty() && !large.empty()) {
+        const int lower = small.back();
+        small.pop_back();
+        const int upper = large.back();
+
+        thresholds[lower] = static_cast<float>(scaled[lower]);
+        aliases[lower] = upper;
+        scaled[upper] -= 1.0 - scaled[lower];
+        if (scaled[upper] < 1.0) {
+            large.pop_back();
+            small.push_back(upper);
+        }
+    }
+    // Whatever is left is one up to rounding.
+}
+
+int AliasTable::Sample(float sample) const
+{
+    const int totalItems = GetTotalItems();
+    if (totalItems == 0) {
+        return -1;
+    }
+
+    const float scaled = sample * static_cast<float>(totalItems);
+    const int column = std::min(static_cast<int>(scaled), totalItems - 1);
+    const float remainder = scaled - static_cast<float>(column);
+    return (remainder < thresholds[column]) ? column : aliases[column];
+}
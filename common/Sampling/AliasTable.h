@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/common.h"
+
+// Walker's alias method: picks one of n items with probability proportional to its weight in constant time, using a
+// single uniform number. Built in O(n) with Vose's variant.
+class AliasTable
+{
+public:
+    // Negative weights count as zero. If all weights are zero the items are picked uniformly.
+    void Build(const std::vector<float>& weights);
+
+    // sample is uniform in [0, 1). Returns -1 if the table is empty.
+    int Sample(float sample) const;
+    float GetProbability(int index) const { return probabilities[index]; }
+
+    int GetTotalItems() const { return static_cast<int>(probabilities.size()); }
+
+private:
+    // Probability of keeping the item of a column instead of taking its alias.
+    std::vector<float> thresholds;
+    std::vector<int> aliases;
+    std::vector<float> probabilities;
+};
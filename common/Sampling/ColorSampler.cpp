@@ -1,4 +1,5 @@
 #include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/RandomSequence.h"
 
 ColorSampler::ColorSampler()
 {
@@ -10,18 +11,21 @@ void ColorSampler::InitializeSampler(Application* app, Scene* inputScene)
     storedScene = inputScene;
 }
 
-std::unique_ptr<SamplerState> ColorSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+std::unique_ptr<SamplerState> ColorSampler::CreateSampler(const int maxSamples, const int dimensions) const
 {
-    return std::move(make_unique<SamplerState>(randomDevice, maxSamples, dimensions));
+    return std::move(make_unique<SamplerState>(maxSamples, dimensions));
 }
 
 glm::vec3 ColorSampler::ComputeSamplesAndColor(const int maxSamples, const int dimensions, std::function<glm::vec3(glm::vec3, int)> colorComputer) const
 {
-    std::random_device randomDevice;
-    std::unique_ptr<SamplerState> newState = CreateSampler(randomDevice, maxSamples, dimensions);
+    std::unique_ptr<SamplerState> newState = CreateSampler(maxSamples, dimensions);
 
     glm::vec3 finalColor;
     for (int i = 0; i < maxSamples; ++i) {
+        // Everything random about sample i, from the sample coordinate to the light and bounce decisions made by
+        // the renderer, comes from the sequence of this sample.
+        RandomSequence::BeginSample(static_cast<uint32_t>(i));
+
         // Compute normalized sample. 
         glm::vec3 sampleCoordinates = ComputeSampleCoordinate(*newState.get());
 
@@ -52,7 +56,7 @@ glm::vec3 ColorSampler::ComputeSampleCoordinate(SamplerState& state) const
 
 float ColorSampler::GenerateRandomNumber(SamplerState& state) const
 {
-    return static_cast<float>(state.dist(state.gen));
+    return RandomSequence::NextFloat();
 }
 
 bool ColorSampler::NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const
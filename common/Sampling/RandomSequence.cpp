@@ -0,0 +1,63 @@
+#include "common/Sampling/RandomSequence.h"
+
+namespace
+{
+    const uint32_t PIXEL_STREAM = 0u;
+    const uint32_t PHOTON_STREAM = 1u;
+    // Spreads consecutive dimensions over the whole input range of the hash.
+    const uint32_t DIMENSION_STRIDE = 0x9E3779B9u;
+}
+
+RandomSequence::ThreadState& RandomSequence::GetThreadState()
+{
+    thread_local ThreadState state = { PIXEL_STREAM, 0u, 0u, Hash(Hash(Hash(PIXEL_STREAM))), 0u };
+    return state;
+}
+
+void RandomSequence::Begin(uint32_t stream, uint32_t index, uint32_t firstSample)
+{
+    ThreadState& state = GetThreadState();
+    state.stream = stream;
+    state.index = index;
+    state.firstSample = firstSample;
+    BeginSample(0);
+}
+
+void RandomSequence::BeginPixel(uint32_t pixelIndex, uint32_t firstSample)
+{
+    Begin(PIXEL_STREAM, pixelIndex, firstSample);
+}
+
+void RandomSequence::BeginPhoton(uint32_t photonIndex)
+{
+    Begin(PHOTON_STREAM, photonIndex, 0u);
+}
+
+void RandomSequence::BeginSample(uint32_t sampleIndex)
+{
+    ThreadState& state = GetThreadState();
+    state.sampleKey = Hash(state.firstSample + sampleIndex + Hash(state.index + Hash(state.stream)));
+    state.dimension = 0u;
+}
+
+float RandomSequence::NextFloat()
+{
+    ThreadState& state = GetThreadState();
+    const uint32_t bits = Hash(state.sampleKey + state.dimension * DIMENSION_STRIDE);
+    ++state.dimension;
+    // The top 24 bits fit a float exactly, so the result stays below one.
+    return static_cast<float>(bits >> 8) * (1.f / 16777216.f);
+}
+
+glm::vec2 RandomSequence::Next2D()
+{
+    const float x = NextFloat();
+    return glm::vec2(x, NextFloat());
+}
+
+uint32_t RandomSequence::Hash(uint32_t input)
+{
+    const uint32_t state = input * 747796405u + 2891336453u;
+    const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/common.h"
+
+// Counter-based random numbers. The n-th number of a sample is a hash of (pixel, sample, n), so no generator state is
+// shared between threads and every sample sees the same numbers no matter which thread renders it, or in what order.
+// Each thread keeps its own position: RayTracer moves it to the pixel being rendered, the color sampler to the sample.
+class RandomSequence
+{
+public:
+    // Starts the numbers of a pixel. Sample indices given to BeginSample are counted from firstSample on, so that
+    // later progressive passes do not repeat the numbers of earlier ones.
+    static void BeginPixel(uint32_t pixelIndex, uint32_t firstSample = 0);
+    // Photon tracing gets numbers of its own, keyed by the index of the photon.
+    static void BeginPhoton(uint32_t photonIndex);
+    // Restarts the dimensions for the given sample of the current pixel (or photon).
+    static void BeginSample(uint32_t sampleIndex);
+
+    // Uniform in [0, 1), one dimension after the other.
+    static float NextFloat();
+    static glm::vec2 Next2D();
+
+private:
+    struct ThreadState
+    {
+        uint32_t stream;
+        uint32_t index;
+        uint32_t firstSample;
+        // Hash of stream, index and sample, shared by all dimensions of the sample.
+        uint32_t sampleKey;
+        uint32_t dimension;
+    };
+    static ThreadState& GetThreadState();
+    static void Begin(uint32_t stream, uint32_t index, uint32_t firstSample);
+
+    // PCG output permutation on a single LCG step; a cheap integer hash with good avalanche.
+    static uint32_t Hash(uint32_t input);
+};
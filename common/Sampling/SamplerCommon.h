@@ -2,4 +2,5 @@
 
 #include "common/Sampling/ColorSampler.h"
 #include "common/Sampling/Jitter/JitterColorSampler.h"
-#include "common/Sampling/Adaptive/Simple/SimpleAdaptiveSampler.h"
\ No newline at end of file
+#include "common/Sampling/Adaptive/Simple/SimpleAdaptiveSampler.h"
+#include "common/Sampling/RandomSequence.h"
\ No newline at end of file
@@ -1,11 +1,12 @@
 #pragma once
 
 #include "common/Scene/SceneObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
 
 class Camera : public SceneObject
 {
 public:
     Camera();
 
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const = 0;
+    virtual Ray GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const = 0;
 };
\ No newline at end of file
@@ -6,7 +6,7 @@ PerspectiveCamera::PerspectiveCamera(float aspectRatio, float inputFov):
 {
 }
 
-std::shared_ptr<Ray> PerspectiveCamera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const
+Ray PerspectiveCamera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const
 {
     // Send ray from the camera to the image plane -- make the assumption that the image plane is at z = 1 in camera space.
     const glm::vec3 rayOrigin = glm::vec3(GetPosition());
@@ -25,7 +25,7 @@ std::shared_ptr<Ray> PerspectiveCamera::GenerateRayForNormalizedCoordinates(glm:
     const glm::vec3 targetPosition = rayOrigin + glm::vec3(GetForwardDirection()) + glm::vec3(GetRightDirection()) * xOffset + glm::vec3(GetUpDirection()) * yOffset;
 
     const glm::vec3 rayDirection = glm::normalize(targetPosition - rayOrigin);
-    return std::make_shared<Ray>(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
+    return Ray(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
 }
 
 float PerspectiveCamera::GetFov(){
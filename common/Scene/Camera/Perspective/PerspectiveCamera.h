@@ -7,7 +7,7 @@ class PerspectiveCamera : public Camera
 public:
     // inputFov is in degrees. 
     PerspectiveCamera(float aspectRatio, float inputFov);
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
+    virtual Ray GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
 
     void SetZNear(float input);
     void SetZFar(float input);
@@ -1,4 +1,5 @@
 #include "common/Scene/Camera/WideAperture/WideApertureCamera.h"
+#include "common/Sampling/RandomSequence.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 
 WideApertureCamera::WideApertureCamera(float aspectRatio, float inputFov, float focalDistance, float apertureRaduis):
@@ -8,11 +9,11 @@ WideApertureCamera::WideApertureCamera(float aspectRatio, float inputFov, float
 {
 }
 
-std::shared_ptr<Ray> WideApertureCamera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const
+Ray WideApertureCamera::GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const
 {
     // Sample a random position on the aperture (uniform, circular, radius r)
-    const float phi = (float)std::rand()/RAND_MAX * 2 * PI;
-    const float rho = r * std::sqrt((float)std::rand()/RAND_MAX);
+    const float phi = RandomSequence::NextFloat() * 2 * PI;
+    const float rho = r * std::sqrt(RandomSequence::NextFloat());
 
     // in Cartesian coordinates
     const float x = rho * cos(phi);
@@ -36,5 +37,5 @@ std::shared_ptr<Ray> WideApertureCamera::GenerateRayForNormalizedCoordinates(glm
     const glm::vec3 focalTarget = cameraOrigin + f*(glm::vec3(GetForwardDirection()) + glm::vec3(GetRightDirection()) * xOffset + glm::vec3(GetUpDirection()) * yOffset);
 
     const glm::vec3 rayDirection = glm::normalize(focalTarget - rayOrigin);
-    return std::make_shared<Ray>(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
+    return Ray(rayOrigin + rayDirection * zNear, rayDirection, zFar - zNear);
 }
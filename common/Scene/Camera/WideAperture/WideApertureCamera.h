@@ -7,7 +7,7 @@ class WideApertureCamera : public PerspectiveCamera
 public:
     // inputFov is in degrees. 
     WideApertureCamera(float aspectRatio, float inputFov, float focalDistance, float apertureRadius);
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
+    virtual Ray GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
 
 private:
     float f;
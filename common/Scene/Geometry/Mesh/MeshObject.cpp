@@ -26,12 +26,16 @@ void MeshObject::AddPrimitive(std::shared_ptr<PrimitiveBase> newPrimitive)
 
 void MeshObject::Finalize()
 {
+    assert(acceleration);
+    if (acceleration->IsInitialized()) {
+        return;
+    }
+
     boundingBox.Reset();
     for (size_t i = 0; i < elements.size(); ++i) {
         elements[i]->Finalize();
         boundingBox.IncludeBox(elements[i]->GetBoundingBox());
     }
-    assert(acceleration);
     acceleration->Initialize(elements);
 }
 
@@ -41,11 +45,23 @@ void MeshObject::CreateAccelerationData(AccelerationTypes perObjectType)
     assert(acceleration);
 }
 
+void MeshObject::AppendTransformedPrimitives(const glm::mat4& transform, std::vector<std::shared_ptr<AccelerationNode>>& output) const
+{
+    for (size_t i = 0; i < elements.size(); ++i) {
+        output.emplace_back(elements[i]->CreateTransformedCopy(transform));
+    }
+}
+
 bool MeshObject::Trace(const SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const
 {
     return acceleration->Trace(parentObject, inputRay, outputIntersection);
 }
 
+bool MeshObject::Occluded(const SceneObject* parentObject, class Ray* inputRay) const
+{
+    return acceleration->Occluded(parentObject, inputRay);
+}
+
 const Material* MeshObject::GetMaterial() const
 {
     return storedMaterial.get();
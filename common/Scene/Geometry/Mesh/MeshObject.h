@@ -9,12 +9,15 @@ public:
     MeshObject();
     MeshObject(std::shared_ptr<class Material> inputMaterial);
     virtual ~MeshObject();
+    // Meshes that are shared between several objects are only built by the first call.
     virtual void Finalize();
 
     void SetName(const std::string& input);
     std::string GetName() const { return meshName; }
     void AddPrimitive(std::shared_ptr<class PrimitiveBase> newPrimitive);
     virtual void CreateAccelerationData(AccelerationTypes perObjectType);
+    // Appends transformed copies of all primitives to output. The mesh itself does not need to be finalized for this.
+    void AppendTransformedPrimitives(const glm::mat4& transform, std::vector<std::shared_ptr<AccelerationNode>>& output) const;
 
     virtual Box GetBoundingBox() const override
     {
@@ -25,6 +28,7 @@ public:
     virtual const class Material* GetMaterial() const;
 
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override;
 
     friend class SceneObject;
 protected:
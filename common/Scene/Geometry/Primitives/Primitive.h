@@ -65,6 +65,12 @@ public:
         return boundingBox;
     }
 
+    // The primitive tests already stop at the first hit when no intersection state is requested.
+    virtual bool Occluded(const class SceneObject* parentObject, class Ray* inputRay) const override
+    {
+        return static_cast<const PrimitiveBase*>(this)->Trace(parentObject, inputRay, nullptr);
+    }
+
     virtual const class MeshObject* GetParentMeshObject() const override
     {
         return parentMesh;
@@ -128,6 +134,19 @@ protected:
     std::array<glm::vec3, N> bitangents;
     bool hasTangentBitangents;
 
+    // Positions go through transform, normals, tangents and bitangents through its inverse transpose.
+    void TransformVertices(const glm::mat4& transform)
+    {
+        const glm::mat3 normalTransform = glm::mat3(glm::transpose(glm::inverse(transform)));
+        for (int i = 0; i < N; ++i) {
+            positions[i] = glm::vec3(transform * glm::vec4(positions[i], 1.f));
+            normals[i] = normalTransform * normals[i];
+            tangents[i] = normalTransform * tangents[i];
+            bitangents[i] = normalTransform * bitangents[i];
+        }
+        UpdateBoundingBox();
+    }
+
     void UpdateBoundingBox()
     {
         boundingBox.Reset();
@@ -13,6 +13,8 @@ public:
     virtual void SetVertexTangentBitangent(int index, glm::vec3 tangent, glm::vec3 bitangent) = 0;
     virtual int GetTotalVertices() const = 0;
     virtual void Finalize() = 0;
+    // Copy of the primitive (still belonging to the same mesh) with all of its vertex data moved by transform.
+    virtual std::shared_ptr<PrimitiveBase> CreateTransformedCopy(const glm::mat4& transform) const = 0;
 
     virtual bool HasVertexNormals() const = 0;
     virtual bool HasNormalMap() const = 0;
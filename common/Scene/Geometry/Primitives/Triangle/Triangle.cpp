@@ -7,6 +7,19 @@ Triangle::Triangle(class MeshObject* inputParent):
 {
 }
 
+void Triangle::Finalize()
+{
+    Primitive<3>::Finalize();
+    UpdateIntersectionRecord();
+}
+
+void Triangle::UpdateIntersectionRecord()
+{
+    record.vertex0 = positions[0];
+    record.edge1 = positions[1] - positions[0];
+    record.edge2 = positions[2] - positions[0];
+}
+
 glm::vec3 Triangle::GetPrimitiveNormal() const
 {
     const glm::vec3 edge1 = glm::normalize(positions[1] - positions[0]);
@@ -14,18 +27,26 @@ glm::vec3 Triangle::GetPrimitiveNormal() const
     return glm::normalize(glm::cross(edge1, edge2));
 }
 
+std::shared_ptr<PrimitiveBase> Triangle::CreateTransformedCopy(const glm::mat4& transform) const
+{
+    std::shared_ptr<Triangle> copy = std::make_shared<Triangle>(*this);
+    copy->TransformVertices(transform);
+    copy->UpdateIntersectionRecord();
+    return copy;
+}
+
 bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
 {
     DIAGNOSTICS_STAT(DiagnosticsType::TRIANGLE_INTERSECTIONS);
     assert(parentObject);
-    // Convert ray into object space.
-    const glm::vec3 rayPos = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetPosition());
-    const glm::vec3 rayDir = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetForwardDirection());
+    // Convert ray into object space. The ray keeps the result, so this is only done once per object.
+    glm::vec3 rayPos, rayDir;
+    inputRay->GetObjectSpaceRay(parentObject, rayPos, rayDir);
 
     // Use Moller-Trumbore Intersection (Fast, Minimum Storage Ray/Triangle Intersection)
     // Paper: http://www.cs.virginia.edu/~gfx/Courses/2003/ImageSynthesis/papers/Acceleration/Fast%20MinimumStorage%20RayTriangle%20Intersection.pdf
-    const glm::vec3 edge1 = positions[1] - positions[0];
-    const glm::vec3 edge2 = positions[2] - positions[0];
+    const glm::vec3& edge1 = record.edge1;
+    const glm::vec3& edge2 = record.edge2;
     const glm::vec3 pvec = glm::cross(rayDir, edge2);
 
     float det = glm::dot(edge1, pvec);
@@ -36,7 +57,7 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
 
     const float invDet = 1.f / det;
 
-    const glm::vec3 tvec = glm::vec3(rayPos) - positions[0];
+    const glm::vec3 tvec = rayPos - record.vertex0;
     const float u = glm::dot(tvec, pvec) * invDet;
     if (u < 0.f || u > 1.f) {
         return false;
@@ -57,17 +78,22 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
         if (t - outputIntersection->intersectionT > SMALL_EPSILON) {
             return false;
         }
-        outputIntersection->intersectionRay = *inputRay;
-        outputIntersection->primitiveParent = parentObject;
-        outputIntersection->intersectionT = t;
-        outputIntersection->intersectedPrimitive = this;
-        outputIntersection->hasIntersection = true;
-
-        outputIntersection->primitiveIntersectionWeights.clear();
-        outputIntersection->primitiveIntersectionWeights.emplace_back(1.f - u - v);
-        outputIntersection->primitiveIntersectionWeights.emplace_back(u);
-        outputIntersection->primitiveIntersectionWeights.emplace_back(v);
+        StoreIntersection(parentObject, inputRay, t, u, v, outputIntersection);
     }
 
     return true;
+}
+
+void Triangle::StoreIntersection(const SceneObject* parentObject, const Ray* inputRay, float t, float u, float v, IntersectionState* outputIntersection) const
+{
+    outputIntersection->intersectionRay = *inputRay;
+    outputIntersection->primitiveParent = parentObject;
+    outputIntersection->intersectionT = t;
+    outputIntersection->intersectedPrimitive = this;
+    outputIntersection->hasIntersection = true;
+    outputIntersection->hasShadingFrame = false;
+
+    outputIntersection->primitiveIntersectionWeights[0] = 1.f - u - v;
+    outputIntersection->primitiveIntersectionWeights[1] = u;
+    outputIntersection->primitiveIntersectionWeights[2] = v;
 }
\ No newline at end of file
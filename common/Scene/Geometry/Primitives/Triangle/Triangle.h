@@ -5,7 +5,26 @@
 class Triangle: public Primitive<3>
 {
 public:
+    // Everything the intersection test needs, computed once when the triangle is finalized.
+    struct IntersectionRecord
+    {
+        glm::vec3 vertex0;
+        glm::vec3 edge1;
+        glm::vec3 edge2;
+    };
+
     Triangle(class MeshObject* inputParent);
+    virtual void Finalize() override;
     virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
     virtual glm::vec3 GetPrimitiveNormal() const override;
+    virtual std::shared_ptr<PrimitiveBase> CreateTransformedCopy(const glm::mat4& transform) const override;
+
+    const IntersectionRecord& GetIntersectionRecord() const { return record; }
+    // Fills in a hit at distance t with the barycentric coordinates u and v (of vertex 1 and 2).
+    void StoreIntersection(const class SceneObject* parentObject, const class Ray* inputRay, float t, float u, float v, struct IntersectionState* outputIntersection) const;
+
+private:
+    IntersectionRecord record;
+
+    void UpdateIntersectionRecord();
 };
\ No newline at end of file
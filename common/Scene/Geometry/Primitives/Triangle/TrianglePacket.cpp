@@ -0,0 +1,243 @@
+#include "common/Scene/Geometry/Primitives/Triangle/TrianglePacket.h"
+#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define TRIANGLE_PACKET_SSE 1
+#endif
+
+// The AVX kernel is always built when the compiler lets us target AVX per function, and only used when the CPU
+// reports support for it. Compilers that cannot do that only get it when the whole project is built with AVX.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRIANGLE_PACKET_AVX 1
+#define TRIANGLE_PACKET_AVX_TARGET
+#elif TRIANGLE_PACKET_SSE && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TRIANGLE_PACKET_AVX 1
+#define TRIANGLE_PACKET_AVX_TARGET __attribute__((target("avx")))
+#endif
+
+bool IsTriangleKernelSupported(TriangleKernel kernel)
+{
+    switch (kernel) {
+    case TriangleKernel::AUTO:
+    case TriangleKernel::SCALAR:
+        return true;
+    case TriangleKernel::SSE:
+#if TRIANGLE_PACKET_SSE
+        return true;
+#else
+        return false;
+#endif
+    case TriangleKernel::AVX:
+#if defined(__AVX__)
+        return true;
+#elif TRIANGLE_PACKET_AVX
+        return __builtin_cpu_supports("avx") != 0;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+TriangleKernel ResolveTriangleKernel(TriangleKernel kernel)
+{
+    if (kernel != TriangleKernel::AUTO && IsTriangleKernelSupported(kernel)) {
+        return kernel;
+    }
+
+    if (IsTriangleKernelSupported(TriangleKernel::AVX)) {
+        return TriangleKernel::AVX;
+    } else if (IsTriangleKernelSupported(TriangleKernel::SSE)) {
+        return TriangleKernel::SSE;
+    }
+    return TriangleKernel::SCALAR;
+}
+
+namespace
+{
+    // All kernels do the same operations in the same order as Triangle::Trace, so every lane reports exactly the
+    // result the scalar test would.
+    int TraceLanesScalar(const TrianglePacket& packet, const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float* t, float* u, float* v, int firstLane, int totalLanes)
+    {
+        int hitMask = 0;
+        for (int lane = firstLane; lane < firstLane + totalLanes; ++lane) {
+            const glm::vec3 edge1(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+            const glm::vec3 edge2(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+            const glm::vec3 vertex0(packet.vertex0[0][lane], packet.vertex0[1][lane], packet.vertex0[2][lane]);
+
+            const glm::vec3 pvec = glm::cross(rayDir, edge2);
+            const float det = glm::dot(edge1, pvec);
+            const float invDet = 1.f / det;
+
+            const glm::vec3 tvec = rayPos - vertex0;
+            const glm::vec3 qvec = glm::cross(tvec, edge1);
+            u[lane] = glm::dot(tvec, pvec) * invDet;
+            v[lane] = glm::dot(rayDir, qvec) * invDet;
+            t[lane] = glm::dot(edge2, qvec) * invDet;
+
+            if (det > -SMALL_EPSILON && det < SMALL_EPSILON) {
+                continue;
+            }
+            if (u[lane] < 0.f || u[lane] > 1.f || v[lane] < 0.f || u[lane] + v[lane] > 1.f) {
+                continue;
+            }
+            if (t[lane] - maxT > SMALL_EPSILON || t[lane] < -SMALL_EPSILON) {
+                continue;
+            }
+            hitMask |= 1 << lane;
+        }
+        return hitMask;
+    }
+
+#if TRIANGLE_PACKET_SSE
+    int TraceFourLanes(const TrianglePacket& packet, const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float* t, float* u, float* v, int firstLane)
+    {
+        __m128 edge1[3], edge2[3], tvec[3], direction[3];
+        for (int i = 0; i < 3; ++i) {
+            edge1[i] = _mm_loadu_ps(&packet.edge1[i][firstLane]);
+            edge2[i] = _mm_loadu_ps(&packet.edge2[i][firstLane]);
+            tvec[i] = _mm_sub_ps(_mm_set1_ps(rayPos[i]), _mm_loadu_ps(&packet.vertex0[i][firstLane]));
+            direction[i] = _mm_set1_ps(rayDir[i]);
+        }
+
+        const __m128 pvec[3] = {
+            _mm_sub_ps(_mm_mul_ps(direction[1], edge2[2]), _mm_mul_ps(edge2[1], direction[2])),
+            _mm_sub_ps(_mm_mul_ps(direction[2], edge2[0]), _mm_mul_ps(edge2[2], direction[0])),
+            _mm_sub_ps(_mm_mul_ps(direction[0], edge2[1]), _mm_mul_ps(edge2[0], direction[1]))
+        };
+        const __m128 qvec[3] = {
+            _mm_sub_ps(_mm_mul_ps(tvec[1], edge1[2]), _mm_mul_ps(edge1[1], tvec[2])),
+            _mm_sub_ps(_mm_mul_ps(tvec[2], edge1[0]), _mm_mul_ps(edge1[2], tvec[0])),
+            _mm_sub_ps(_mm_mul_ps(tvec[0], edge1[1]), _mm_mul_ps(edge1[0], tvec[1]))
+        };
+
+        auto dot = [](const __m128* a, const __m128* b) {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+        };
+        const __m128 det = dot(edge1, pvec);
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.f), det);
+        const __m128 laneU = _mm_mul_ps(dot(tvec, pvec), invDet);
+        const __m128 laneV = _mm_mul_ps(dot(direction, qvec), invDet);
+        const __m128 laneT = _mm_mul_ps(dot(edge2, qvec), invDet);
+        _mm_storeu_ps(u + firstLane, laneU);
+        _mm_storeu_ps(v + firstLane, laneV);
+        _mm_storeu_ps(t + firstLane, laneT);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 epsilon = _mm_set1_ps(SMALL_EPSILON);
+        __m128 hit = _mm_or_ps(_mm_cmple_ps(det, _mm_set1_ps(-SMALL_EPSILON)), _mm_cmpge_ps(det, epsilon));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(laneU, zero), _mm_cmple_ps(laneU, one)));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(laneV, zero), _mm_cmple_ps(_mm_add_ps(laneU, laneV), one)));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_sub_ps(laneT, _mm_set1_ps(maxT)), epsilon));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(laneT, _mm_set1_ps(-SMALL_EPSILON)));
+        return _mm_movemask_ps(hit) << firstLane;
+    }
+#endif
+
+#if TRIANGLE_PACKET_AVX
+    TRIANGLE_PACKET_AVX_TARGET
+    int TraceEightLanes(const TrianglePacket& packet, const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float* t, float* u, float* v)
+    {
+        __m256 edge1[3], edge2[3], tvec[3], direction[3];
+        for (int i = 0; i < 3; ++i) {
+            edge1[i] = _mm256_loadu_ps(packet.edge1[i]);
+            edge2[i] = _mm256_loadu_ps(packet.edge2[i]);
+            tvec[i] = _mm256_sub_ps(_mm256_set1_ps(rayPos[i]), _mm256_loadu_ps(packet.vertex0[i]));
+            direction[i] = _mm256_set1_ps(rayDir[i]);
+        }
+
+        const __m256 pvec[3] = {
+            _mm256_sub_ps(_mm256_mul_ps(direction[1], edge2[2]), _mm256_mul_ps(edge2[1], direction[2])),
+            _mm256_sub_ps(_mm256_mul_ps(direction[2], edge2[0]), _mm256_mul_ps(edge2[2], direction[0])),
+            _mm256_sub_ps(_mm256_mul_ps(direction[0], edge2[1]), _mm256_mul_ps(edge2[0], direction[1]))
+        };
+        const __m256 qvec[3] = {
+            _mm256_sub_ps(_mm256_mul_ps(tvec[1], edge1[2]), _mm256_mul_ps(edge1[1], tvec[2])),
+            _mm256_sub_ps(_mm256_mul_ps(tvec[2], edge1[0]), _mm256_mul_ps(edge1[2], tvec[0])),
+            _mm256_sub_ps(_mm256_mul_ps(tvec[0], edge1[1]), _mm256_mul_ps(edge1[0], tvec[1]))
+        };
+
+        const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(edge1[0], pvec[0]), _mm256_mul_ps(edge1[1], pvec[1])), _mm256_mul_ps(edge1[2], pvec[2]));
+        const __m256 invDet = _mm256_div_ps(_mm256_set1_ps(1.f), det);
+        const __m256 laneU = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tvec[0], pvec[0]), _mm256_mul_ps(tvec[1], pvec[1])), _mm256_mul_ps(tvec[2], pvec[2])), invDet);
+        const __m256 laneV = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(direction[0], qvec[0]), _mm256_mul_ps(direction[1], qvec[1])), _mm256_mul_ps(direction[2], qvec[2])), invDet);
+        const __m256 laneT = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(edge2[0], qvec[0]), _mm256_mul_ps(edge2[1], qvec[1])), _mm256_mul_ps(edge2[2], qvec[2])), invDet);
+        _mm256_storeu_ps(u, laneU);
+        _mm256_storeu_ps(v, laneV);
+        _mm256_storeu_ps(t, laneT);
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256 epsilon = _mm256_set1_ps(SMALL_EPSILON);
+        __m256 hit = _mm256_or_ps(_mm256_cmp_ps(det, _mm256_set1_ps(-SMALL_EPSILON), _CMP_LE_OQ), _mm256_cmp_ps(det, epsilon, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(laneU, zero, _CMP_GE_OQ), _mm256_cmp_ps(laneU, one, _CMP_LE_OQ)));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(laneV, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(laneU, laneV), one, _CMP_LE_OQ)));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_sub_ps(laneT, _mm256_set1_ps(maxT)), epsilon, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(laneT, _mm256_set1_ps(-SMALL_EPSILON), _CMP_GE_OQ));
+        return _mm256_movemask_ps(hit);
+    }
+#endif
+}
+
+TrianglePacket::TrianglePacket():
+    count(0)
+{
+    for (int lane = 0; lane < WIDTH; ++lane) {
+        ClearTriangle(lane);
+    }
+}
+
+void TrianglePacket::SetTriangle(int lane, const Triangle* triangle)
+{
+    assert(lane >= 0 && lane < WIDTH && triangle);
+    const Triangle::IntersectionRecord& record = triangle->GetIntersectionRecord();
+    for (int i = 0; i < 3; ++i) {
+        vertex0[i][lane] = record.vertex0[i];
+        edge1[i][lane] = record.edge1[i];
+        edge2[i][lane] = record.edge2[i];
+    }
+    triangles[lane] = triangle;
+    count = std::max(count, lane + 1);
+}
+
+void TrianglePacket::ClearTriangle(int lane)
+{
+    assert(lane >= 0 && lane < WIDTH);
+    for (int i = 0; i < 3; ++i) {
+        vertex0[i][lane] = 0.f;
+        edge1[i][lane] = 0.f;
+        edge2[i][lane] = 0.f;
+    }
+    triangles[lane] = nullptr;
+}
+
+int TrianglePacket::Trace(TriangleKernel kernel, const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float* t, float* u, float* v) const
+{
+    DIAGNOSTICS_STAT_ADD(DiagnosticsType::TRIANGLE_INTERSECTIONS, count);
+    int hitMask = 0;
+    switch (kernel) {
+#if TRIANGLE_PACKET_AVX
+    case TriangleKernel::AVX:
+        hitMask = TraceEightLanes(*this, rayPos, rayDir, maxT, t, u, v);
+        break;
+#endif
+#if TRIANGLE_PACKET_SSE
+    case TriangleKernel::SSE:
+        hitMask = TraceFourLanes(*this, rayPos, rayDir, maxT, t, u, v, 0);
+        if (count > 4) {
+            hitMask |= TraceFourLanes(*this, rayPos, rayDir, maxT, t, u, v, 4);
+        }
+        break;
+#endif
+    default:
+        hitMask = TraceLanesScalar(*this, rayPos, rayDir, maxT, t, u, v, 0, count);
+        break;
+    }
+
+    // Cleared lanes cannot hit, but lanes past count may not have been tested at all.
+    return hitMask & ((1 << count) - 1);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common/common.h"
+
+enum class TriangleKernel
+{
+    AUTO,       // the widest kernel the CPU supports, checked at runtime
+    SCALAR,     // one lane after the other, mostly for testing the SIMD kernels against
+    SSE,        // 4 lanes at a time
+    AVX         // 8 lanes at a time
+};
+
+// Whether the CPU we are running on can execute the given kernel. AUTO and SCALAR are always supported.
+bool IsTriangleKernelSupported(TriangleKernel kernel);
+// Turns AUTO (or a kernel the CPU does not support) into the best supported kernel.
+TriangleKernel ResolveTriangleKernel(TriangleKernel kernel);
+
+// Up to WIDTH triangles in structure-of-arrays form, one array of WIDTH floats per axis for vertex 0 and the two
+// edges. The Moller-Trumbore test runs on all lanes at once with the chosen kernel. The layout does not depend on
+// the kernel, so it can be picked at runtime.
+struct TrianglePacket
+{
+    static const int WIDTH = 8;
+
+    TrianglePacket();
+
+    void SetTriangle(int lane, const class Triangle* triangle);
+    // An empty lane has degenerate edges and never reports a hit.
+    void ClearTriangle(int lane);
+
+    // Returns a bit mask of the triangles hit between -SMALL_EPSILON and maxT + SMALL_EPSILON (bit i for lane i)
+    // and stores the distance and barycentric coordinates of every lane in t, u and v. The ray has to be in the
+    // space the triangles are stored in.
+    int Trace(TriangleKernel kernel, const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float* t, float* u, float* v) const;
+
+    float vertex0[3][WIDTH];
+    float edge1[3][WIDTH];
+    float edge2[3][WIDTH];
+    const class Triangle* triangles[WIDTH];
+    int count;
+};
@@ -1,50 +1,27 @@
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/SceneObject.h"
 
 Ray::Ray() :
-    rayDirection(glm::vec3(0.f, 0.f, -1.f)), maxT(std::numeric_limits<float>::max())
+    position(0.f, 0.f, 0.f), maxT(std::numeric_limits<float>::max()), rayDirection(glm::vec3(0.f, 0.f, -1.f)), objectSpaceOwner(nullptr)
 {
-    position = glm::vec4(0.f, 0.f, 0.f, 1.f);
 }
 
 Ray::Ray(glm::vec3 inputPosition, glm::vec3 inputDirection, float inputMaxT):
-    rayDirection(glm::normalize(inputDirection)), maxT(inputMaxT)
+    position(inputPosition), maxT(inputMaxT), rayDirection(glm::normalize(inputDirection)), objectSpaceOwner(nullptr)
 {
-    position = glm::vec4(inputPosition, 1.f);
 }
 
-glm::vec4 Ray::GetForwardDirection() const
+void Ray::GetObjectSpaceRay(const SceneObject* object, glm::vec3& outputPosition, glm::vec3& outputDirection)
 {
-    return glm::vec4(GetRayDirection(), 0.f);
-}
-
-glm::vec3 Ray::GetRayDirection() const
-{
-    return rayDirection;
-}
-
-float Ray::GetMaxT() const
-{
-    return maxT;
-}
-
-void Ray::SetMaxT(float input)
-{
-    maxT = input;
-}
-
-glm::vec3 Ray::GetRayPosition(float t) const
-{
-    return glm::vec3(position) + t * rayDirection;
-}
-
-void Ray::SetRayMask(uint64_t objectId)
-{
-    traceMask[objectId] = true;
-}
-
-bool Ray::IsObjectMasked(uint64_t objectId)
-{
-    return traceMask[objectId];
+    assert(object);
+    if (object != objectSpaceOwner) {
+        const glm::mat4 worldToObject = object->GetWorldToObjectMatrix();
+        objectSpacePosition = glm::vec3(worldToObject * GetPosition());
+        objectSpaceDirection = glm::vec3(worldToObject * GetForwardDirection());
+        objectSpaceOwner = object;
+    }
+    outputPosition = objectSpacePosition;
+    outputDirection = objectSpaceDirection;
 }
 
 glm::vec3 Ray::RefractRay(const glm::vec3& normal, float n1, float& n2) const
@@ -60,4 +37,4 @@ glm::vec3 Ray::RefractRay(const glm::vec3& normal, float n1, float& n2) const
     const float cosTheta2 = std::sqrt(1.f - tirCheck);
     const glm::vec3 refractionDir = eta * GetRayDirection() + (eta * cosTheta1 - cosTheta2) * normal;
     return refractionDir;
-}
\ No newline at end of file
+}
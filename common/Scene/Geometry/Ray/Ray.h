@@ -1,31 +1,41 @@
 #pragma once
 
-#include "common/Scene/SceneObject.h"
+#include "common/common.h"
 
-class Ray : public SceneObject
+// A plain value type: rays are created and copied for every sample, shadow test and photon bounce, so they carry
+// nothing but the ray itself and the cached object space version of it.
+class Ray
 {
 public:
     Ray();
     Ray(glm::vec3 inputPosition, glm::vec3 inputDirection, float inputMaxT = std::numeric_limits<float>::max());
 
-    void SetRayPosition(const glm::vec3& input) { position = glm::vec4(input, 1.f); }
-    void SetRayDirection(const glm::vec3& input) { rayDirection = input; } 
+    void SetRayPosition(const glm::vec3& input) { position = input; objectSpaceOwner = nullptr; }
+    void SetRayDirection(const glm::vec3& input) { rayDirection = input; objectSpaceOwner = nullptr; }
 
-    virtual glm::vec4 GetForwardDirection() const override;
-    glm::vec3 GetRayDirection() const;
+    glm::vec4 GetPosition() const { return glm::vec4(position, 1.f); }
+    glm::vec4 GetForwardDirection() const { return glm::vec4(rayDirection, 0.f); }
+    glm::vec3 GetRayDirection() const { return rayDirection; }
 
-    glm::vec3 GetRayPosition(float t) const;
+    glm::vec3 GetRayPosition(float t) const { return position + t * rayDirection; }
 
-    float GetMaxT() const;
-    void SetMaxT(float input);
-
-    void SetRayMask(uint64_t objectId);
-    bool IsObjectMasked(uint64_t objectId);
+    float GetMaxT() const { return maxT; }
+    void SetMaxT(float input) { maxT = input; }
 
     glm::vec3 RefractRay(const glm::vec3& normal, float n1, float& n2) const;
+
+    // Position and direction in the object space of the given object. All primitives of an object ask for the same
+    // space, so the result for the most recent object is kept and the matrix is only applied once per object.
+    void GetObjectSpaceRay(const class SceneObject* object, glm::vec3& outputPosition, glm::vec3& outputDirection);
 private:
-    glm::vec3 rayDirection;
+    glm::vec3 position;
     float maxT;
+    glm::vec3 rayDirection;
+
+    const class SceneObject* objectSpaceOwner;
+    glm::vec3 objectSpacePosition;
+    glm::vec3 objectSpaceDirection;
+};
 
-    std::unordered_map<uint64_t, bool> traceMask;
-};
\ No newline at end of file
+static_assert(std::is_trivially_copyable<Ray>::value, "Rays are copied around a lot and must stay trivially copyable.");
+static_assert(sizeof(Ray) <= 64, "Ray is supposed to fit in a cache line.");
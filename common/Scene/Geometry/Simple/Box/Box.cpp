@@ -1,4 +1,5 @@
 #include "common/Scene/Geometry/Simple/Box/Box.h"
+#include "common/Scene/Geometry/Simple/Box/BoxPacket.h"
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 #include "common/Intersection/IntersectionState.h"
@@ -25,6 +26,12 @@ void Box::IncludeBox(const Box& box)
     maxVertex = glm::max(maxVertex, box.maxVertex);
 }
 
+void Box::IncludePoint(const glm::vec3& point)
+{
+    minVertex = glm::min(minVertex, point);
+    maxVertex = glm::max(maxVertex, point);
+}
+
 glm::vec3 Box::Center() const
 {
     return 0.5f * (minVertex + maxVertex);
@@ -32,7 +39,6 @@ glm::vec3 Box::Center() const
 
 bool Box::Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const
 {
-    DIAGNOSTICS_STAT(DiagnosticsType::BOX_INTERSECTIONS);
     glm::mat4 spaceTransform(1.f);
     if (parentObject) {
         spaceTransform = parentObject->GetWorldToObjectMatrix();
@@ -45,6 +51,25 @@ bool Box::Trace(const class SceneObject* parentObject, class Ray* inputRay, stru
     //std::cout << "Trace Box Ray: " << glm::to_string(rayPos) << " " << glm::to_string(rayDir) << std::endl;
     //std::cout << "  Box: " << glm::to_string(minVertex) << " " << glm::to_string(maxVertex) << std::endl;
 
+    const float maxT = outputIntersection ? std::min(inputRay->GetMaxT(), outputIntersection->intersectionT) : inputRay->GetMaxT();
+    float entryT = 0.f;
+    float exitT = 0.f;
+    if (!Trace(rayPos, rayDir, maxT, entryT, exitT)) {
+        return false;
+    }
+
+    // WARNING: Ray-Box intersection isn't as well supported as ray-triangle intersection. This bit is kinda hacky atm.
+    if (outputIntersection) {
+        outputIntersection->intersectionT = (entryT > SMALL_EPSILON) ? entryT : exitT;
+    }
+
+    return true;
+}
+
+bool Box::Trace(const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float& entryT, float& exitT) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::BOX_INTERSECTIONS);
+
     float globalMinT = std::numeric_limits<float>::lowest();
     float globalMaxT = std::numeric_limits<float>::max();
 
@@ -81,18 +106,32 @@ bool Box::Trace(const class SceneObject* parentObject, class Ray* inputRay, stru
         return false;
     }
 
-    if (globalMinT - inputRay->GetMaxT() > SMALL_EPSILON || globalMaxT < SMALL_EPSILON) {
+    if (globalMinT - maxT > SMALL_EPSILON || globalMaxT < SMALL_EPSILON) {
         return false;
     }
 
-    // WARNING: Ray-Box intersection isn't as well supported as ray-triangle intersection. This bit is kinda hacky atm.
-    if (outputIntersection) {
-        if (globalMinT - outputIntersection->intersectionT > SMALL_EPSILON) {
-            return false;
-        }
-        outputIntersection->intersectionT = (globalMinT > SMALL_EPSILON) ? globalMinT : globalMaxT;
+    entryT = globalMinT;
+    exitT = globalMaxT;
+    return true;
+}
+
+bool Box::Trace(const BoxRay& ray, float maxT, float& entryT) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::BOX_INTERSECTIONS);
+
+    const glm::vec3 corners[2] = { minVertex, maxVertex };
+    float globalMinT = (corners[ray.directionIsNegative[0]].x - ray.position.x) * ray.inverseDirection.x;
+    float globalMaxT = (corners[1 - ray.directionIsNegative[0]].x - ray.position.x) * ray.inverseDirection.x;
+    for (int i = 1; i < 3; ++i) {
+        globalMinT = std::max(globalMinT, (corners[ray.directionIsNegative[i]][i] - ray.position[i]) * ray.inverseDirection[i]);
+        globalMaxT = std::min(globalMaxT, (corners[1 - ray.directionIsNegative[i]][i] - ray.position[i]) * ray.inverseDirection[i]);
     }
+    globalMaxT *= BoxRay::EXIT_PADDING;
 
+    if (globalMinT > globalMaxT || globalMaxT < SMALL_EPSILON || globalMinT - maxT > SMALL_EPSILON) {
+        return false;
+    }
+    entryT = globalMinT;
     return true;
 }
 
@@ -139,4 +178,10 @@ float Box::Volume() const
 {
     glm::vec3 diagonal = maxVertex - minVertex;
     return diagonal[0] * diagonal[1] * diagonal[2];
+}
+
+float Box::SurfaceArea() const
+{
+    glm::vec3 diagonal = glm::max(maxVertex - minVertex, glm::vec3(0.f));
+    return 2.f * (diagonal[0] * diagonal[1] + diagonal[1] * diagonal[2] + diagonal[2] * diagonal[0]);
 }
\ No newline at end of file
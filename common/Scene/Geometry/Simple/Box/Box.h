@@ -2,6 +2,8 @@
 
 #include "common/common.h"
 
+struct BoxRay;
+
 class Box
 {
 public:
@@ -10,10 +12,20 @@ public:
 
     void Reset();
     void IncludeBox(const Box& box);
+    void IncludePoint(const glm::vec3& point);
     glm::vec3 Center() const;
     float Volume() const;
+    // Returns 0 for an empty box.
+    float SurfaceArea() const;
 
     bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+
+    // Slab test for a ray that is already in the space of the box. Succeeds if the ray enters the box before maxT;
+    // entryT and exitT are then set to where the ray enters and leaves the slabs.
+    bool Trace(const glm::vec3& rayPos, const glm::vec3& rayDir, float maxT, float& entryT, float& exitT) const;
+
+    // Branch-free slab test against a ray with precomputed inverse direction. Same hit rules as above.
+    bool Trace(const BoxRay& ray, float maxT, float& entryT) const;
     
     Box Expand(float delta) const;
     Box Transform(glm::mat4 transformation) const;
@@ -0,0 +1,161 @@
+#include "common/Scene/Geometry/Simple/Box/BoxPacket.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BOX_PACKET_SSE 1
+#endif
+
+const float BoxRay::EXIT_PADDING = 1.f + 4.f * std::numeric_limits<float>::epsilon();
+
+BoxRay::BoxRay(const glm::vec3& rayPos, const glm::vec3& rayDir):
+    position(rayPos)
+{
+    for (int i = 0; i < 3; ++i) {
+        float direction = rayDir[i];
+        if (std::abs(direction) < SMALL_EPSILON) {
+            direction = std::signbit(direction) ? -SMALL_EPSILON : SMALL_EPSILON;
+        }
+        inverseDirection[i] = 1.f / direction;
+        directionIsNegative[i] = (direction < 0.f) ? 1 : 0;
+    }
+}
+
+namespace
+{
+    template<int N>
+    int TraceLanesScalar(const float (&bounds)[2][3][N], const BoxRay& ray, float maxT, float* entryT, int firstLane, int totalLanes)
+    {
+        int hitMask = 0;
+        for (int lane = firstLane; lane < firstLane + totalLanes; ++lane) {
+            float laneMinT = std::numeric_limits<float>::lowest();
+            float laneMaxT = std::numeric_limits<float>::max();
+            for (int i = 0; i < 3; ++i) {
+                laneMinT = std::max(laneMinT, (bounds[ray.directionIsNegative[i]][i][lane] - ray.position[i]) * ray.inverseDirection[i]);
+                laneMaxT = std::min(laneMaxT, (bounds[1 - ray.directionIsNegative[i]][i][lane] - ray.position[i]) * ray.inverseDirection[i]);
+            }
+            laneMaxT *= BoxRay::EXIT_PADDING;
+
+            entryT[lane] = laneMinT;
+            if (laneMinT <= laneMaxT && laneMaxT >= SMALL_EPSILON && laneMinT - maxT <= SMALL_EPSILON) {
+                hitMask |= 1 << lane;
+            }
+        }
+        return hitMask;
+    }
+
+#if BOX_PACKET_SSE
+    template<int N>
+    int TraceFourLanes(const float (&bounds)[2][3][N], const BoxRay& ray, float maxT, float* entryT, int firstLane)
+    {
+        __m128 laneMinT = _mm_set1_ps(std::numeric_limits<float>::lowest());
+        __m128 laneMaxT = _mm_set1_ps(std::numeric_limits<float>::max());
+        for (int i = 0; i < 3; ++i) {
+            const __m128 position = _mm_set1_ps(ray.position[i]);
+            const __m128 inverseDirection = _mm_set1_ps(ray.inverseDirection[i]);
+            const __m128 nearSlab = _mm_loadu_ps(&bounds[ray.directionIsNegative[i]][i][firstLane]);
+            const __m128 farSlab = _mm_loadu_ps(&bounds[1 - ray.directionIsNegative[i]][i][firstLane]);
+            laneMinT = _mm_max_ps(laneMinT, _mm_mul_ps(_mm_sub_ps(nearSlab, position), inverseDirection));
+            laneMaxT = _mm_min_ps(laneMaxT, _mm_mul_ps(_mm_sub_ps(farSlab, position), inverseDirection));
+        }
+        laneMaxT = _mm_mul_ps(laneMaxT, _mm_set1_ps(BoxRay::EXIT_PADDING));
+        _mm_storeu_ps(entryT + firstLane, laneMinT);
+
+        __m128 hit = _mm_cmple_ps(laneMinT, laneMaxT);
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(laneMaxT, _mm_set1_ps(SMALL_EPSILON)));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(laneMinT, _mm_set1_ps(maxT + SMALL_EPSILON)));
+        return _mm_movemask_ps(hit) << firstLane;
+    }
+#endif
+
+#if defined(__AVX__)
+    int TraceEightLanes(const float (&bounds)[2][3][8], const BoxRay& ray, float maxT, float* entryT)
+    {
+        __m256 laneMinT = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+        __m256 laneMaxT = _mm256_set1_ps(std::numeric_limits<float>::max());
+        for (int i = 0; i < 3; ++i) {
+            const __m256 position = _mm256_set1_ps(ray.position[i]);
+            const __m256 inverseDirection = _mm256_set1_ps(ray.inverseDirection[i]);
+            const __m256 nearSlab = _mm256_loadu_ps(bounds[ray.directionIsNegative[i]][i]);
+            const __m256 farSlab = _mm256_loadu_ps(bounds[1 - ray.directionIsNegative[i]][i]);
+            laneMinT = _mm256_max_ps(laneMinT, _mm256_mul_ps(_mm256_sub_ps(nearSlab, position), inverseDirection));
+            laneMaxT = _mm256_min_ps(laneMaxT, _mm256_mul_ps(_mm256_sub_ps(farSlab, position), inverseDirection));
+        }
+        laneMaxT = _mm256_mul_ps(laneMaxT, _mm256_set1_ps(BoxRay::EXIT_PADDING));
+        _mm256_storeu_ps(entryT, laneMinT);
+
+        __m256 hit = _mm256_cmp_ps(laneMinT, laneMaxT, _CMP_LE_OQ);
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(laneMaxT, _mm256_set1_ps(SMALL_EPSILON), _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(laneMinT, _mm256_set1_ps(maxT + SMALL_EPSILON), _CMP_LE_OQ));
+        return _mm256_movemask_ps(hit);
+    }
+#endif
+
+    int TraceLanes(const float (&bounds)[2][3][4], const BoxRay& ray, float maxT, float* entryT)
+    {
+#if BOX_PACKET_SSE
+        return TraceFourLanes(bounds, ray, maxT, entryT, 0);
+#else
+        return TraceLanesScalar(bounds, ray, maxT, entryT, 0, 4);
+#endif
+    }
+
+    int TraceLanes(const float (&bounds)[2][3][8], const BoxRay& ray, float maxT, float* entryT)
+    {
+#if defined(__AVX__)
+        return TraceEightLanes(bounds, ray, maxT, entryT);
+#elif BOX_PACKET_SSE
+        return TraceFourLanes(bounds, ray, maxT, entryT, 0) | TraceFourLanes(bounds, ray, maxT, entryT, 4);
+#else
+        return TraceLanesScalar(bounds, ray, maxT, entryT, 0, 8);
+#endif
+    }
+}
+
+template<int N>
+BoxPacket<N>::BoxPacket()
+{
+    for (int lane = 0; lane < N; ++lane) {
+        ClearBox(lane);
+    }
+}
+
+template<int N>
+void BoxPacket<N>::SetBox(int lane, const Box& box)
+{
+    assert(lane >= 0 && lane < N);
+    for (int i = 0; i < 3; ++i) {
+        bounds[0][i][lane] = box.minVertex[i];
+        bounds[1][i][lane] = box.maxVertex[i];
+    }
+}
+
+template<int N>
+void BoxPacket<N>::ClearBox(int lane)
+{
+    SetBox(lane, Box());
+}
+
+template<int N>
+Box BoxPacket<N>::GetBox(int lane) const
+{
+    assert(lane >= 0 && lane < N);
+    Box box;
+    for (int i = 0; i < 3; ++i) {
+        box.minVertex[i] = bounds[0][i][lane];
+        box.maxVertex[i] = bounds[1][i][lane];
+    }
+    return box;
+}
+
+template<int N>
+int BoxPacket<N>::Trace(const BoxRay& ray, float maxT, float* entryT) const
+{
+    DIAGNOSTICS_STAT_ADD(DiagnosticsType::BOX_INTERSECTIONS, N);
+    return TraceLanes(bounds, ray, maxT, entryT);
+}
+
+template struct BoxPacket<4>;
+template struct BoxPacket<8>;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Scene/Geometry/Simple/Box/Box.h"
+
+// Everything the slab tests need from a ray, computed once per ray instead of once per box.
+struct BoxRay
+{
+    BoxRay(const glm::vec3& rayPos, const glm::vec3& rayDir);
+
+    // Exit distances get scaled by this so that rounding does not make rays miss flat boxes.
+    static const float EXIT_PADDING;
+
+    glm::vec3 position;
+    // Directions that are (almost) zero are clamped to +/-SMALL_EPSILON first so that no slab produces a NaN.
+    glm::vec3 inverseDirection;
+    int directionIsNegative[3];
+};
+
+// N boxes in structure-of-arrays form: bounds[0] holds the minimum corners and bounds[1] the maximum corners,
+// one array of N floats per axis. The slab test runs on all N boxes at once with SSE (N = 4) or AVX (N = 8), or
+// falls back to a scalar loop when those are not available.
+template<int N>
+struct BoxPacket
+{
+    BoxPacket();
+
+    void SetBox(int lane, const Box& box);
+    // An empty lane never reports a hit.
+    void ClearBox(int lane);
+    Box GetBox(int lane) const;
+
+    // Returns a bit mask of the boxes the ray enters before maxT (bit i for lane i) and stores the entry distance
+    // of every lane in entryT.
+    int Trace(const BoxRay& ray, float maxT, float* entryT) const;
+
+    float bounds[2][3][N];
+};
@@ -1,27 +1,28 @@
 #include "common/Scene/Lights/Area/AreaLight.h"
+#include "common/Sampling/RandomSequence.h"
 
 AreaLight::AreaLight(const glm::vec2& size):
-    samplesToUse(4), lightSize(size)
+    gridSize(2, 2), samplesToUse(4), lightSize(size)
 {
-    sampler = make_unique<JitterColorSampler>();
-    sampler->SetGridSize(glm::ivec3(2, 2, 1));
 }
 
 void AreaLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
 {
+    const glm::ivec2 sampleGrid = ComputeSampleGrid(origin);
     origin += normal * LARGE_EPSILON;
-    std::random_device rd;
-    std::unique_ptr<SamplerState> sampleState = sampler->CreateSampler(rd, samplesToUse, 2);
-    for (int i = 0; i < samplesToUse; ++i) {
-        glm::vec3 sample = sampler->ComputeSampleCoordinate(*sampleState.get()) - 0.5f;
-        sample.x *= lightSize.x;
-        sample.y *= lightSize.y;
-        sample.z = 0.f;
 
-        const glm::vec3 lightPosition = glm::vec3(GetObjectToWorldMatrix() * glm::vec4(sample, 1.f));
-        const glm::vec3 rayDirection = glm::normalize(lightPosition - origin);
-        const float distanceToOrigin = glm::distance(origin, lightPosition);
-        output.emplace_back(origin, rayDirection, distanceToOrigin);
+    const glm::mat4 objectToWorld = GetObjectToWorldMatrix();
+    for (int y = 0; y < sampleGrid.y; ++y) {
+        for (int x = 0; x < sampleGrid.x; ++x) {
+            glm::vec3 sample((static_cast<float>(x) + RandomSequence::NextFloat()) / static_cast<float>(sampleGrid.x) - 0.5f, (static_cast<float>(y) + RandomSequence::NextFloat()) / static_cast<float>(sampleGrid.y) - 0.5f, 0.f);
+            sample.x *= lightSize.x;
+            sample.y *= lightSize.y;
+
+            const glm::vec3 lightPosition = glm::vec3(objectToWorld * glm::vec4(sample, 1.f));
+            const glm::vec3 rayDirection = glm::normalize(lightPosition - origin);
+            const float distanceToOrigin = glm::distance(origin, lightPosition);
+            output.emplace_back(origin, rayDirection, distanceToOrigin);
+        }
     }
 }
 
@@ -31,7 +32,8 @@ float AreaLight::ComputeLightAttenuation(glm::vec3 origin) const
     if (glm::dot(lightToPoint, glm::vec3(GetForwardDirection())) < -SMALL_EPSILON) {
         return 0.f;
     }
-    return 1.f / static_cast<float>(samplesToUse);
+    const glm::ivec2 sampleGrid = ComputeSampleGrid(origin);
+    return 1.f / static_cast<float>(sampleGrid.x * sampleGrid.y);
 }
 
 void AreaLight::GenerateRandomPhotonRay(Ray& ray) const
@@ -40,6 +42,82 @@ void AreaLight::GenerateRandomPhotonRay(Ray& ray) const
 
 void AreaLight::SetSamplerAttributes(glm::ivec3 inputGridSize, int numSamples)
 {
-    sampler->SetGridSize(inputGridSize);
-    samplesToUse = numSamples;
+    assert(inputGridSize.x > 0 && inputGridSize.y > 0);
+    gridSize = glm::ivec2(inputGridSize.x, inputGridSize.y);
+    samplesToUse = std::max(numSamples, 1);
+}
+
+glm::ivec2 AreaLight::ComputeSampleGrid(const glm::vec3& origin) const
+{
+    // Solid angle of the light seen from origin, as if all of it were as far away and as tilted as its center.
+    const glm::mat4 objectToWorld = GetObjectToWorldMatrix();
+    const glm::vec3 edgeX = glm::vec3(objectToWorld * glm::vec4(lightSize.x, 0.f, 0.f, 0.f));
+    const glm::vec3 edgeY = glm::vec3(objectToWorld * glm::vec4(0.f, lightSize.y, 0.f, 0.f));
+    const glm::vec3 centerToPoint = origin - glm::vec3(objectToWorld * glm::vec4(0.f, 0.f, 0.f, 1.f));
+    const float distance2 = std::max(glm::length2(centerToPoint), SMALL_EPSILON);
+    const float cosLight = std::abs(glm::dot(centerToPoint, glm::normalize(glm::vec3(GetForwardDirection())))) / std::sqrt(distance2);
+    const float solidAngle = std::min(glm::length(glm::cross(edgeX, edgeY)) * cosLight / distance2, 2.f * PI);
+
+    // Shrink the grid evenly in both directions until it has about as many cells as we want samples.
+    const int fullGridCells = gridSize.x * gridSize.y;
+    const int wantedSamples = std::min(ComputeAdaptiveSampleCount(solidAngle, samplesToUse), fullGridCells);
+    if (wantedSamples >= fullGridCells) {
+        return gridSize;
+    }
+    const float scale = std::sqrt(static_cast<float>(wantedSamples) / static_cast<float>(fullGridCells));
+    return glm::max(glm::ivec2(glm::round(glm::vec2(gridSize) * scale)), glm::ivec2(1, 1));
+}
+
+bool AreaLight::SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const
+{
+    const glm::mat4 objectToWorld = GetObjectToWorldMatrix();
+    const glm::vec3 lightPosition = glm::vec3(objectToWorld * glm::vec4((sample.x - 0.5f) * lightSize.x, (sample.y - 0.5f) * lightSize.y, 0.f, 1.f));
+    const glm::vec3 toLight = lightPosition - origin;
+    output.distance = glm::length(toLight);
+    if (output.distance < SMALL_EPSILON) {
+        return false;
+    }
+    output.direction = toLight / output.distance;
+
+    // The light only shines along its forward direction.
+    const float cosLight = -glm::dot(output.direction, glm::normalize(glm::vec3(GetForwardDirection())));
+    const glm::vec3 edgeX = glm::vec3(objectToWorld * glm::vec4(lightSize.x, 0.f, 0.f, 0.f));
+    const glm::vec3 edgeY = glm::vec3(objectToWorld * glm::vec4(0.f, lightSize.y, 0.f, 0.f));
+    const float area = glm::length(glm::cross(edgeX, edgeY));
+    if (cosLight < SMALL_EPSILON || area < SMALL_EPSILON) {
+        return false;
+    }
+
+    // A uniform point on the light, so every sample is worth the full light color like in ComputeSampleRays.
+    output.pdf = output.distance * output.distance / (area * cosLight);
+    output.contribution = lightColor;
+    return true;
+}
+
+bool AreaLight::IntersectLight(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance, glm::vec3& radiance, float& pdf) const
+{
+    const glm::vec3 lightNormal = glm::normalize(glm::vec3(GetForwardDirection()));
+    const float cosLight = -glm::dot(direction, lightNormal);
+    if (cosLight < SMALL_EPSILON) {
+        return false;
+    }
+
+    const glm::mat4 objectToWorld = GetObjectToWorldMatrix();
+    const glm::vec3 lightCenter = glm::vec3(objectToWorld * glm::vec4(0.f, 0.f, 0.f, 1.f));
+    distance = glm::dot(origin - lightCenter, lightNormal) / cosLight;
+    if (distance < SMALL_EPSILON || distance >= maxDistance) {
+        return false;
+    }
+
+    const glm::vec3 edgeX = glm::vec3(objectToWorld * glm::vec4(lightSize.x, 0.f, 0.f, 0.f));
+    const glm::vec3 edgeY = glm::vec3(objectToWorld * glm::vec4(0.f, lightSize.y, 0.f, 0.f));
+    const glm::vec3 centerToHit = origin + distance * direction - lightCenter;
+    const float area = glm::length(glm::cross(edgeX, edgeY));
+    if (area < SMALL_EPSILON || std::abs(glm::dot(centerToHit, edgeX)) > 0.5f * glm::length2(edgeX) || std::abs(glm::dot(centerToHit, edgeY)) > 0.5f * glm::length2(edgeY)) {
+        return false;
+    }
+
+    pdf = distance * distance / (area * cosLight);
+    radiance = PI * lightColor * pdf;
+    return true;
 }
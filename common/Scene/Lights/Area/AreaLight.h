@@ -1,7 +1,6 @@
 #pragma once
 
 #include "common/Scene/Lights/Light.h"
-#include "common/Sampling/Jitter/JitterColorSampler.h"
 
 class AreaLight : public Light
 {
@@ -13,10 +12,18 @@ public:
 
     virtual void GenerateRandomPhotonRay(Ray& ray) const override;
 
+    virtual bool SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const override;
+    virtual bool IntersectLight(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance, glm::vec3& radiance, float& pdf) const override;
+
     // Sampler Attributes
+    // ComputeSampleRays takes one jittered sample in every cell of a grid over the light. A light that looks large
+    // uses the full grid (x and y of inputGridSize); smaller ones use a coarser grid with about as many cells as
+    // Light::ComputeAdaptiveSampleCount asks for, never more than numSamples.
     void SetSamplerAttributes(glm::ivec3 inputGridSize, int numSamples);
 private:
-    std::unique_ptr<JitterColorSampler> sampler;
+    glm::ivec2 ComputeSampleGrid(const glm::vec3& origin) const;
+
+    glm::ivec2 gridSize;
     int samplesToUse;
     glm::vec2 lightSize;
 };
@@ -13,4 +13,13 @@ float DirectionalLight::ComputeLightAttenuation(glm::vec3 origin) const
 
 void DirectionalLight::GenerateRandomPhotonRay(Ray& ray) const
 {
-}
\ No newline at end of file
+}
+
+bool DirectionalLight::SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const
+{
+    output.direction = -1.f * glm::vec3(GetForwardDirection());
+    output.distance = std::numeric_limits<float>::max();
+    output.contribution = lightColor * ComputeLightAttenuation(origin);
+    output.pdf = 0.f;
+    return true;
+}
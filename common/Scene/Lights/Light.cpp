@@ -1,5 +1,7 @@
 #include "common/Scene/Lights/Light.h"
 
+const float Light::SOLID_ANGLE_PER_SAMPLE = 0.005f;
+
 glm::vec3 Light::GetLightColor() const
 {
     return lightColor;
@@ -8,4 +10,18 @@ glm::vec3 Light::GetLightColor() const
 void Light::SetLightColor(glm::vec3 input)
 {
     lightColor = input;
-}
\ No newline at end of file
+}
+
+bool Light::IntersectLight(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance, glm::vec3& radiance, float& pdf) const
+{
+    return false;
+}
+
+int Light::ComputeAdaptiveSampleCount(float solidAngle, int maximumSamples)
+{
+    // Compare before dividing so that huge solid angles can not overflow the int.
+    if (solidAngle >= SOLID_ANGLE_PER_SAMPLE * static_cast<float>(maximumSamples)) {
+        return std::max(maximumSamples, 1);
+    }
+    return std::max(static_cast<int>(std::ceil(solidAngle / SOLID_ANGLE_PER_SAMPLE)), 1);
+}
@@ -3,6 +3,19 @@
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 
+// One direction towards a light, picked for a single shading point.
+struct LightSample
+{
+    glm::vec3 direction;        // from the shading point towards the light
+    float distance;             // to the sampled point on the light, the maximum float for directional lights
+    // What the light contributes per unit of the material's BRDF response (see Material::ComputeBRDF), already
+    // divided by the pdf. For a point light this is just its color and attenuation.
+    glm::vec3 contribution;
+    // Solid angle density the direction was picked with. Zero for lights that can not be hit by a ray (point, spot
+    // and directional lights); those are only ever reached by sampling them.
+    float pdf;
+};
+
 class Light : public SceneObject
 {
 public:
@@ -15,6 +28,20 @@ public:
     // Photon Mapping Utility Functions
     virtual void GenerateRandomPhotonRay(Ray& ray) const = 0;
 
+    // Path Tracing Utility Functions
+    // Lights keep the units of ComputeSampleRays: the light color times the average BRDF response over the light,
+    // without distance falloff. Returns false if the light does not reach origin. sample holds two uniform numbers in [0, 1).
+    virtual bool SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const = 0;
+    // For lights with an extent: whether the ray from origin along direction hits the light closer than maxDistance.
+    // If it does, radiance is what the light adds along the ray (to be weighted with the BRDF response over PI) and
+    // pdf is the density SampleLight would have picked the direction with.
+    virtual bool IntersectLight(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance, glm::vec3& radiance, float& pdf) const;
+
 protected:
+    // Shadow rays worth spending on a light that covers solidAngle as seen from the shading point: one for every
+    // SOLID_ANGLE_PER_SAMPLE steradians, at least one and at most maximumSamples.
+    static int ComputeAdaptiveSampleCount(float solidAngle, int maximumSamples);
+    static const float SOLID_ANGLE_PER_SAMPLE;
+
     glm::vec3 lightColor;
-};
\ No newline at end of file
+};
@@ -1,4 +1,5 @@
 #include "common/Scene/Lights/Point/PointLight.h"
+#include "common/Sampling/RandomSequence.h"
 
 
 void PointLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
@@ -25,11 +26,25 @@ void PointLight::GenerateRandomPhotonRay(Ray& ray) const
     float y = 1.;
     float z = 1.;
     while (x*x + y*y + z*z > 1){
-        x = (float)std::rand() / RAND_MAX * 2 - 1;
-        y = (float)std::rand() / RAND_MAX * 2 - 1;
-        z = (float)std::rand() / RAND_MAX * 2 - 1;
+        x = RandomSequence::NextFloat() * 2 - 1;
+        y = RandomSequence::NextFloat() * 2 - 1;
+        z = RandomSequence::NextFloat() * 2 - 1;
     }
     glm::vec3 rayDir = glm::vec3(x, y, z);
     ray.SetRayPosition(rayPos);
     ray.SetRayDirection(rayDir);
 }
+
+
+bool PointLight::SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const
+{
+    const glm::vec3 toLight = glm::vec3(GetPosition()) - origin;
+    output.distance = glm::length(toLight);
+    if (output.distance < SMALL_EPSILON) {
+        return false;
+    }
+    output.direction = toLight / output.distance;
+    output.contribution = lightColor * ComputeLightAttenuation(origin);
+    output.pdf = 0.f;
+    return true;
+}
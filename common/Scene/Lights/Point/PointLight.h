@@ -9,4 +9,6 @@ public:
     virtual float ComputeLightAttenuation(glm::vec3 origin) const override;
 
     virtual void GenerateRandomPhotonRay(Ray& ray) const override;
+
+    virtual bool SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const override;
 };
\ No newline at end of file
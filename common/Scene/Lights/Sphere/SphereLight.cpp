@@ -1,4 +1,5 @@
 #include "common/Scene/Lights/Sphere/SphereLight.h"
+#include "common/Sampling/RandomSequence.h"
 
 SphereLight::SphereLight(float radius):
     samplesToUse(4), lightRadius(radius)
@@ -7,8 +8,8 @@ SphereLight::SphereLight(float radius):
 
 glm::vec3 sampleUnitSphere(){
 
-    float u = (float)std::rand() / RAND_MAX * 2 -1; //uniform in [0, 1)
-    float theta = (float)std::rand() / RAND_MAX *2 * PI; //uniform in [0, 2*PI)
+    float u = RandomSequence::NextFloat() * 2 -1; //uniform in [0, 1)
+    float theta = RandomSequence::NextFloat() *2 * PI; //uniform in [0, 2*PI)
 
     float x = std::sqrt(1-u*u) * std::cos(theta);
     float y = std::sqrt(1-u*u) * std::sin(theta);
@@ -21,35 +22,125 @@ glm::vec3 sampleUnitSphere(){
 
 void SphereLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
 {
+    const int totalSamples = ComputeSampleCount(origin);
     origin += normal * LARGE_EPSILON;
-    for (int i = 0; i < samplesToUse; ++i) {
 
-        const glm::vec3 lightCenter = glm::vec3(GetPosition());
-        const glm::vec3 cRay = glm::normalize(lightCenter - origin); // ray TOWARDS light center
-        glm::vec3 sample = sampleUnitSphere();
+    float sinThetaMax2 = 0.f;
+    float cosThetaMax = 0.f;
+    glm::vec3 toCenter;
+    if (totalSamples == 0 || !ComputeVisibleCone(origin, toCenter, sinThetaMax2, cosThetaMax)) {
+        return;
+    }
 
-//        while (cRay.x*sample.x + cRay.y*sample.y + cRay.z*sample.z > 0){ // half space constraint
-//            sample = sampleUnitSphere();
-//        }
+    // Only the half of the sphere that faces origin can be seen, so sample directions in the cone it covers. The
+    // samples are stratified in the angle from the cone axis.
+    for (int i = 0; i < totalSamples; ++i) {
+        const glm::vec2 sample((static_cast<float>(i) + RandomSequence::NextFloat()) / static_cast<float>(totalSamples), RandomSequence::NextFloat());
+        const glm::vec3 rayDirection = SampleConeDirection(toCenter, sinThetaMax2, cosThetaMax, sample);
+        output.emplace_back(origin, rayDirection, ComputeDistanceToSurface(toCenter, rayDirection));
+    }
+}
 
-        glm::vec3 lightPosition = sample*lightRadius + lightCenter;
+float SphereLight::ComputeLightAttenuation(glm::vec3 origin) const
+{
+    // Every sample stands for an equal part of the visible light.
+    const int totalSamples = ComputeSampleCount(origin);
+    return (totalSamples > 0) ? 1.f / static_cast<float>(totalSamples) : 0.f;
+}
 
-        const glm::vec3 rayDirection = glm::normalize(lightPosition - origin);
-        const float distanceToOrigin = glm::distance(origin, lightPosition);
-        output.emplace_back(origin, rayDirection, distanceToOrigin);
+void SphereLight::SetMaximumSamples(int input)
+{
+    samplesToUse = std::max(input, 1);
+}
+
+bool SphereLight::SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const
+{
+    float sinThetaMax2 = 0.f;
+    float cosThetaMax = 0.f;
+    glm::vec3 toCenter;
+    if (!ComputeVisibleCone(origin, toCenter, sinThetaMax2, cosThetaMax)) {
+        return false;
     }
+    output.direction = SampleConeDirection(toCenter, sinThetaMax2, cosThetaMax, sample);
+    output.distance = ComputeDistanceToSurface(toCenter, output.direction);
+
+    // Every direction in the cone is worth the full light color, the same average ComputeSampleRays takes.
+    output.pdf = 1.f / (2.f * PI * sinThetaMax2 / (1.f + cosThetaMax));
+    output.contribution = lightColor;
+    return true;
 }
 
-float SphereLight::ComputeLightAttenuation(glm::vec3 origin) const
+bool SphereLight::IntersectLight(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance, glm::vec3& radiance, float& pdf) const
+{
+    float sinThetaMax2 = 0.f;
+    float cosThetaMax = 0.f;
+    glm::vec3 toCenter;
+    if (!ComputeVisibleCone(origin, toCenter, sinThetaMax2, cosThetaMax)) {
+        return false;
+    }
+
+    const float b = glm::dot(direction, toCenter);
+    const float discriminant = b * b - glm::length2(toCenter) + lightRadius * lightRadius;
+    if (discriminant < 0.f) {
+        return false;
+    }
+    distance = b - std::sqrt(discriminant);
+    if (distance < SMALL_EPSILON || distance >= maxDistance) {
+        return false;
+    }
+
+    pdf = 1.f / (2.f * PI * sinThetaMax2 / (1.f + cosThetaMax));
+    radiance = PI * lightColor * pdf;
+    return true;
+}
+
+bool SphereLight::ComputeVisibleCone(const glm::vec3& origin, glm::vec3& toCenter, float& sinThetaMax2, float& cosThetaMax) const
 {
-//    const glm::vec3 lightToPoint = glm::normalize(origin - glm::vec3(GetPosition()));
-//    if (glm::dot(lightToPoint, glm::vec3(GetForwardDirection())) < -SMALL_EPSILON) {
-//        return 0.f;
-//    }
-//    return 1.f / static_cast<float>(samplesToUse);
-    return 1.f;
+    toCenter = glm::vec3(GetPosition()) - origin;
+    const float distance2 = glm::length2(toCenter);
+    const float radius2 = lightRadius * lightRadius;
+    if (distance2 <= radius2 || radius2 <= 0.f) {
+        // Points inside the light (or a light without a surface) have no cone to sample.
+        return false;
+    }
+    sinThetaMax2 = radius2 / distance2;
+    cosThetaMax = std::sqrt(std::max(1.f - sinThetaMax2, 0.f));
+    return true;
 }
 
+glm::vec3 SphereLight::SampleConeDirection(const glm::vec3& toCenter, float sinThetaMax2, float cosThetaMax, const glm::vec2& sample) const
+{
+    // 1 - cos(thetaMax) without the cancellation for small cones.
+    const float oneMinusCosThetaMax = sinThetaMax2 / (1.f + cosThetaMax);
+    const float cosTheta = 1.f - sample.x * oneMinusCosThetaMax;
+    const float sinTheta = std::sqrt(std::max(1.f - cosTheta * cosTheta, 0.f));
+    const float phi = 2.f * PI * sample.y;
+
+    const glm::vec3 axis = glm::normalize(toCenter);
+    const glm::vec3 helper = (std::abs(axis.x) > 0.9f) ? glm::vec3(0.f, 1.f, 0.f) : glm::vec3(1.f, 0.f, 0.f);
+    const glm::vec3 tangent = glm::normalize(glm::cross(helper, axis));
+    const glm::vec3 bitangent = glm::cross(axis, tangent);
+    return glm::normalize(sinTheta * std::cos(phi) * tangent + sinTheta * std::sin(phi) * bitangent + cosTheta * axis);
+}
+
+float SphereLight::ComputeDistanceToSurface(const glm::vec3& toCenter, const glm::vec3& direction) const
+{
+    // Near intersection; directions from the cone graze the sphere at worst.
+    const float b = glm::dot(direction, toCenter);
+    const float discriminant = b * b - glm::length2(toCenter) + lightRadius * lightRadius;
+    return b - std::sqrt(std::max(discriminant, 0.f));
+}
+
+int SphereLight::ComputeSampleCount(const glm::vec3& origin) const
+{
+    float sinThetaMax2 = 0.f;
+    float cosThetaMax = 0.f;
+    glm::vec3 toCenter;
+    if (!ComputeVisibleCone(origin, toCenter, sinThetaMax2, cosThetaMax)) {
+        return 0;
+    }
+    return ComputeAdaptiveSampleCount(2.f * PI * sinThetaMax2 / (1.f + cosThetaMax), samplesToUse);
+}
 
 void SphereLight::GenerateRandomPhotonRay(Ray& ray) const
 {
@@ -67,9 +158,9 @@ void SphereLight::GenerateRandomPhotonRay(Ray& ray) const
     float z = 1.;
 //    while ((x*x + y*y + z*z > 1) && (x*sample.x + y*sample.y && z*sample.z < 0)){ // with half space constraint
     while (x*x + y*y + z*z > 1){ // without half space constraint
-        x = (float)std::rand() / RAND_MAX * 2 - 1;
-        y = (float)std::rand() / RAND_MAX * 2 - 1;
-        z = (float)std::rand() / RAND_MAX * 2 - 1;
+        x = RandomSequence::NextFloat() * 2 - 1;
+        y = RandomSequence::NextFloat() * 2 - 1;
+        z = RandomSequence::NextFloat() * 2 - 1;
     }
 
     glm::vec3 rayDir = glm::vec3(x, y, z);
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "common/Scene/Lights/Light.h"
-#include "common/Sampling/Jitter/JitterColorSampler.h"
 
 class SphereLight : public Light
 {
@@ -13,7 +12,21 @@ public:
 
     virtual void GenerateRandomPhotonRay(Ray& ray) const override;
 
+    // Upper limit for the shadow rays of ComputeSampleRays. Fewer are used when the light looks small (see
+    // Light::ComputeAdaptiveSampleCount).
+    void SetMaximumSamples(int input);
+
+    virtual bool SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const override;
+    virtual bool IntersectLight(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance, glm::vec3& radiance, float& pdf) const override;
+
 private:
+    // Returns false for points inside the sphere. sinThetaMax2 is the squared sine of the half angle of the cone.
+    bool ComputeVisibleCone(const glm::vec3& origin, glm::vec3& toCenter, float& sinThetaMax2, float& cosThetaMax) const;
+    glm::vec3 SampleConeDirection(const glm::vec3& toCenter, float sinThetaMax2, float cosThetaMax, const glm::vec2& sample) const;
+    float ComputeDistanceToSurface(const glm::vec3& toCenter, const glm::vec3& direction) const;
+    // Zero for points inside the light.
+    int ComputeSampleCount(const glm::vec3& origin) const;
+
     int samplesToUse;
     float lightRadius;
 };
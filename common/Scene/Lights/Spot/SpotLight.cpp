@@ -1,4 +1,5 @@
 #include "common/Scene/Lights/Spot/SpotLight.h"
+#include "common/Sampling/RandomSequence.h"
 
 SpotLight::SpotLight(const float theta1, const float theta2):
     cos_t1(std::cos(theta1)), cos_t2(std::cos(theta2))
@@ -47,11 +48,26 @@ void SpotLight::GenerateRandomPhotonRay(Ray& ray) const
     float y = 1.;
     float z = 1.;
     while (x*x + y*y + z*z > 1){
-        x = (float)std::rand() / RAND_MAX * 2 - 1;
-        y = (float)std::rand() / RAND_MAX * 2 - 1;
-        z = (float)std::rand() / RAND_MAX * 2 - 1;
+        x = RandomSequence::NextFloat() * 2 - 1;
+        y = RandomSequence::NextFloat() * 2 - 1;
+        z = RandomSequence::NextFloat() * 2 - 1;
     }
     glm::vec3 rayDir = glm::vec3(x, y, z);
     ray.SetRayPosition(rayPos);
     ray.SetRayDirection(rayDir);
 }
+
+
+bool SpotLight::SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const
+{
+    const glm::vec3 toLight = glm::vec3(GetPosition()) - origin;
+    output.distance = glm::length(toLight);
+    const float attenuation = ComputeLightAttenuation(origin);
+    if (output.distance < SMALL_EPSILON || attenuation <= 0.f) {
+        return false;
+    }
+    output.direction = toLight / output.distance;
+    output.contribution = lightColor * attenuation;
+    output.pdf = 0.f;
+    return true;
+}
@@ -11,6 +11,8 @@ public:
 
     virtual void GenerateRandomPhotonRay(Ray& ray) const override;
 
+    virtual bool SampleLight(const glm::vec3& origin, const glm::vec2& sample, LightSample& output) const override;
+
 private:
     float cos_t1;
     float cos_t2;
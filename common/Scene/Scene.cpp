@@ -1,10 +1,17 @@
 #include "common/Scene/Scene.h"
+#include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
+#include "common/Scene/Lights/Light.h"
 #include "common/Acceleration/AccelerationCommon.h"
 
+Scene::Scene():
+    flattenHierarchy(false)
+{
+}
+
 void Scene::GenerateDefaultAccelerationData()
 {
     if (!acceleration) {
@@ -28,43 +35,26 @@ AccelerationStructure* Scene::GenerateAccelerationData(AccelerationTypes inputTy
 bool Scene::Trace(class Ray* inputRay, IntersectionState* outputIntersection) const
 {
     assert(inputRay);
+    if (!outputIntersection) {
+        return Occluded(inputRay);
+    }
     DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
 
-    bool didIntersect = acceleration->Trace(nullptr, inputRay, outputIntersection);
-    if (outputIntersection != nullptr && didIntersect) {
-        const MeshObject* intersectedMesh = outputIntersection->intersectedPrimitive->GetParentMeshObject();
-        assert(intersectedMesh);
-        const Material* currentMaterial = intersectedMesh->GetMaterial();
-        assert(currentMaterial);
-
-        const glm::vec3 intersectionPoint = outputIntersection->intersectionRay.GetRayPosition(outputIntersection->intersectionT);
-        const float NdR = glm::dot(inputRay->GetRayDirection(), outputIntersection->ComputeNormal());
-        // send out reflection ray.
-        if (currentMaterial->IsReflective() && outputIntersection->remainingReflectionBounces > 0) {
-            outputIntersection->reflectionIntersection = std::make_shared<IntersectionState>(outputIntersection->remainingReflectionBounces - 1, outputIntersection->remainingRefractionBounces);
-
-            Ray reflectionRay;
-            PerformRaySpecularReflection(reflectionRay, *inputRay, intersectionPoint, NdR, *outputIntersection);
-            Trace(&reflectionRay, outputIntersection->reflectionIntersection.get());
-        }
-
-        // send out refraction ray.
-        if (currentMaterial->IsTransmissive() && outputIntersection->remainingRefractionBounces > 0) {
-            outputIntersection->refractionIntersection = std::make_shared<IntersectionState>(outputIntersection->remainingReflectionBounces, outputIntersection->remainingRefractionBounces - 1);
-
-            // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
-            float targetIOR = (NdR < SMALL_EPSILON) ? currentMaterial->GetIOR() : 1.f;
-
-            Ray refractionRay;
-            PerformRayRefraction(refractionRay, *inputRay, intersectionPoint, NdR, *outputIntersection, targetIOR);
-            outputIntersection->refractionIntersection->currentIOR = targetIOR;
-            Trace(&refractionRay, outputIntersection->refractionIntersection.get());
-        }
+    bool didIntersect = acceleration->Trace(worldSpaceObject.get(), inputRay, outputIntersection);
+    if (didIntersect) {
+        outputIntersection->UpdateShadingFrame();
     }
 
     return didIntersect;
 }
 
+bool Scene::Occluded(class Ray* inputRay) const
+{
+    assert(inputRay);
+    DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
+    return acceleration->Occluded(worldSpaceObject.get(), inputRay);
+}
+
 void Scene::PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const
 {
     const glm::vec3 normal = (NdR > SMALL_EPSILON) ? -1.f * state.ComputeNormal() : state.ComputeNormal();
@@ -80,6 +70,30 @@ void Scene::PerformRayRefraction(Ray& outputRay, const Ray& inputRay, const glm:
     outputRay.SetRayDirection(refractionDir);
 }
 
+int Scene::SampleLight(float sample, float& probability) const
+{
+    const int totalLights = static_cast<int>(sceneLights.size());
+    if (totalLights == 0) {
+        return -1;
+    }
+    if (lightSelection.GetTotalItems() != totalLights) {
+        probability = 1.f / static_cast<float>(totalLights);
+        return std::min(static_cast<int>(sample * totalLights), totalLights - 1);
+    }
+
+    const int lightIndex = lightSelection.Sample(sample);
+    probability = lightSelection.GetProbability(lightIndex);
+    return lightIndex;
+}
+
+float Scene::GetLightSelectionProbability(size_t index) const
+{
+    if (lightSelection.GetTotalItems() != static_cast<int>(sceneLights.size())) {
+        return 1.f / static_cast<float>(sceneLights.size());
+    }
+    return lightSelection.GetProbability(static_cast<int>(index));
+}
+
 void Scene::AddSceneObject(std::shared_ptr<SceneObject> object)
 {
     if (!object) {
@@ -98,9 +112,55 @@ void Scene::AddLight(std::shared_ptr<Light> light)
 
 void Scene::Finalize()
 {
+    assert(acceleration);
+
+    std::vector<float> lightPower(sceneLights.size());
+    for (size_t i = 0; i < sceneLights.size(); ++i) {
+        const glm::vec3 lightColor = sceneLights[i]->GetLightColor();
+        lightPower[i] = lightColor.x + lightColor.y + lightColor.z;
+    }
+    lightSelection.Build(lightPower);
+
+    if (!flattenHierarchy) {
+        worldSpaceObject = nullptr;
+        for (size_t i = 0; i < sceneObjects.size(); ++i) {
+            sceneObjects[i]->Finalize();
+        }
+        acceleration->Initialize(sceneObjects);
+        return;
+    }
+
+    std::unordered_map<const MeshObject*, int> meshUsers;
+    for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        for (int m = 0; m < sceneObjects[i]->GetTotalMeshObjects(); ++m) {
+            ++meshUsers[sceneObjects[i]->GetMeshObject(m)];
+        }
+    }
+
+    std::vector<std::shared_ptr<AccelerationNode>> globalNodes;
+    int instancedObjects = 0;
     for (size_t i = 0; i < sceneObjects.size(); ++i) {
-        sceneObjects[i]->Finalize();
+        bool isInstanced = (sceneObjects[i]->GetMaterialOverride() != nullptr);
+        for (int m = 0; m < sceneObjects[i]->GetTotalMeshObjects(); ++m) {
+            isInstanced |= (meshUsers[sceneObjects[i]->GetMeshObject(m)] > 1);
+        }
+
+        if (isInstanced) {
+            sceneObjects[i]->Finalize();
+            globalNodes.emplace_back(sceneObjects[i]);
+            ++instancedObjects;
+        } else {
+            sceneObjects[i]->AppendWorldSpacePrimitives(globalNodes);
+        }
     }
-    assert(acceleration);
-    acceleration->Initialize(sceneObjects);
+
+    // Instances transform the ray themselves and ignore their parent, the baked primitives are already in world space.
+    worldSpaceObject = std::make_shared<SceneObject>();
+    acceleration->Initialize(globalNodes);
+    DIAGNOSTICS_LOG("Flattened scene: " + std::to_string(globalNodes.size() - instancedObjects) + " primitives, " + std::to_string(instancedObjects) + " instanced objects");
+}
+
+void Scene::SetFlattenHierarchy(bool input)
+{
+    flattenHierarchy = input;
 }
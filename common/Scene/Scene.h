@@ -2,6 +2,7 @@
 
 #include "common/common.h"
 #include "common/Intersection/IntersectionState.h"
+#include "common/Sampling/AliasTable.h"
 
 enum class AccelerationTypes;
 class Light;
@@ -10,14 +11,19 @@ class SceneObject;
 class Scene : public std::enable_shared_from_this<Scene>
 {
 public:
+    Scene();
+
     void GenerateDefaultAccelerationData();
     class AccelerationStructure* GenerateAccelerationData(AccelerationTypes inputType);
 
     // if outputIntersection is NULL, this merely checks whether or not the inputRay hits something.
     // if outputIntersection is NOT NULL, then this will check whether or not the inputRay hits something,
-    //      and if it does, it will store that information and perform reflection/refraction and keep going.
+    //      and if it does, it will store that information. Reflection and refraction rays are left to the renderer.
     bool Trace(class Ray* inputRay, IntersectionState* outputIntersection) const;
 
+    // Shadow ray query: true if anything is hit before the maximum t of the ray. Stops at the first hit found.
+    bool Occluded(class Ray* inputRay) const;
+
     size_t GetTotalObjects() const
     {
         return sceneObjects.size();
@@ -45,16 +51,32 @@ public:
         return nullptr;
     }
 
+    // Light importance sampling: picks a light with probability proportional to its power (the sum of its color
+    // channels) for a uniform sample in [0, 1). Returns -1 if there are no lights. The table is built by Finalize;
+    // lights added later make it fall back to picking uniformly.
+    int SampleLight(float sample, float& probability) const;
+    float GetLightSelectionProbability(size_t index) const;
+
     void AddSceneObject(std::shared_ptr<SceneObject> object);
     void AddLight(std::shared_ptr<Light> light);
 
     void Finalize();
 
+    // Makes Finalize bake the object transforms into copies of the primitives and build the scene acceleration
+    // structure directly over those, instead of nesting the per-object and per-mesh structures. Objects that share
+    // a mesh with another object (instances) or override their material keep their own structures and are added as a whole.
+    void SetFlattenHierarchy(bool input);
+
     void PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const;
     void PerformRayRefraction(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state, float& targetIOR) const;
 private:
     std::shared_ptr<class AccelerationStructure> acceleration;
 
+    bool flattenHierarchy;
+    // Identity-transform parent of the baked primitives of a flattened scene; null otherwise.
+    std::shared_ptr<SceneObject> worldSpaceObject;
+
     std::vector<std::shared_ptr<SceneObject>> sceneObjects;
     std::vector<std::shared_ptr<Light>> sceneLights;
+    AliasTable lightSelection;
 };
\ No newline at end of file
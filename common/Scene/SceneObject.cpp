@@ -6,7 +6,7 @@
 const float SceneObject::MINIMUM_SCALE = 0.01f;
 
 SceneObject::SceneObject():
-    worldToObjectMatrix(1.f), objectToWorldMatrix(1.f), position(0.f, 0.f, 0.f, 1.f), rotation(1.f, 0.f, 0.f, 0.f), scale(1.f), nameSet(false)
+    worldToObjectMatrix(1.f), objectToWorldMatrix(1.f), normalMatrix(1.f), position(0.f, 0.f, 0.f, 1.f), rotation(1.f, 0.f, 0.f, 0.f), scale(1.f), baseTransform(1.f), nameSet(false)
 {
 }
 
@@ -25,13 +25,19 @@ glm::mat4 SceneObject::GetWorldToObjectMatrix() const
     return worldToObjectMatrix;
 }
 
+glm::mat3 SceneObject::GetNormalMatrix() const
+{
+    return normalMatrix;
+}
+
 void SceneObject::UpdateTransformationMatrix()
 {
-    objectToWorldMatrix = glm::mat4(1.f);
+    objectToWorldMatrix = baseTransform;
     objectToWorldMatrix = glm::scale(glm::mat4(1.f), scale) * objectToWorldMatrix;
     objectToWorldMatrix = glm::mat4_cast(rotation) * objectToWorldMatrix;
     objectToWorldMatrix = glm::translate(glm::mat4(1.f), glm::vec3(position)) * objectToWorldMatrix;
     worldToObjectMatrix = glm::inverse(objectToWorldMatrix);
+    normalMatrix = glm::mat3(glm::transpose(worldToObjectMatrix));
 }
 
 glm::vec4 SceneObject::GetForwardDirection() const
@@ -70,6 +76,12 @@ void SceneObject::SetPosition(const glm::vec3& in)
     UpdateTransformationMatrix();
 }
 
+void SceneObject::SetBaseTransform(const glm::mat4& input)
+{
+    baseTransform = input;
+    UpdateTransformationMatrix();
+}
+
 void SceneObject::Translate(const glm::vec3& translation)
 {
     position += glm::vec4(translation, 0.f);
@@ -152,20 +164,46 @@ void SceneObject::Finalize()
     }
     boundingBox = boundingBox.Transform(objectToWorldMatrix);
 
+    // The structure over the meshes lives in object space, so all instances can use the one the first of them built.
     assert(acceleration);
-    acceleration->Initialize(childObjects);
+    if (!acceleration->IsInitialized()) {
+        acceleration->Initialize(childObjects);
+    }
 }
 
-bool SceneObject::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+std::shared_ptr<SceneObject> SceneObject::CreateInstance() const
 {
-    if (inputRay->IsObjectMasked(GetUniqueId())) {
-        return false;
-    }
-    bool hit = acceleration->Trace(this, inputRay, outputIntersection);
-    if (!hit) {
-        inputRay->SetRayMask(GetUniqueId());
+    // Without a structure the instance would later get a default one of its own and share nothing.
+    assert(acceleration);
+    std::shared_ptr<SceneObject> instance = std::make_shared<SceneObject>();
+    instance->childObjects = childObjects;
+    instance->acceleration = acceleration;
+    instance->materialOverride = materialOverride;
+    instance->nameSet = nameSet;
+    instance->objectName = objectName;
+    return instance;
+}
+
+void SceneObject::SetMaterialOverride(std::shared_ptr<Material> input)
+{
+    materialOverride = std::move(input);
+}
+
+void SceneObject::AppendWorldSpacePrimitives(std::vector<std::shared_ptr<AccelerationNode>>& output) const
+{
+    for (size_t i = 0; i < childObjects.size(); ++i) {
+        childObjects[i]->AppendTransformedPrimitives(objectToWorldMatrix, output);
     }
-    return hit;
+}
+
+bool SceneObject::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    return acceleration->Trace(this, inputRay, outputIntersection);
+}
+
+bool SceneObject::Occluded(const SceneObject* parentObject, Ray* inputRay) const
+{
+    return acceleration->Occluded(this, inputRay);
 }
 
 std::string SceneObject::GetChildObjectNames() const
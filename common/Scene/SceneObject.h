@@ -11,6 +11,8 @@ public:
 
     virtual glm::mat4 GetObjectToWorldMatrix() const;
     virtual glm::mat4 GetWorldToObjectMatrix() const;
+    // Inverse transpose of the object to world matrix, for normals.
+    virtual glm::mat3 GetNormalMatrix() const;
 
     virtual glm::vec4 GetForwardDirection() const;
     virtual glm::vec4 GetRightDirection() const;
@@ -29,6 +31,8 @@ public:
     void AddScale(float inputScale);
 
     void SetPosition(const glm::vec3& in);
+    // Applied before scale, rotation and translation, e.g. for placements read from a file.
+    void SetBaseTransform(const glm::mat4& input);
 
     //
     // Individual transform retrieval.
@@ -41,6 +45,17 @@ public:
     virtual const class MeshObject* GetMeshObject(int index) const;
     virtual void Finalize();
 
+    // A new object at the origin that shares the meshes and acceleration structures of this one, so that only the
+    // transform (and optionally the material) is stored per instance. Call CreateAccelerationData on this object
+    // first; the instance shares the structure that exists at the time of the call.
+    std::shared_ptr<SceneObject> CreateInstance() const;
+    // Used instead of the materials of the meshes for every hit on this object.
+    void SetMaterialOverride(std::shared_ptr<class Material> input);
+    const class Material* GetMaterialOverride() const { return materialOverride.get(); }
+
+    // Appends world space copies of the primitives of all meshes to output, for scenes that flatten the hierarchy.
+    virtual void AppendWorldSpacePrimitives(std::vector<std::shared_ptr<AccelerationNode>>& output) const;
+
     virtual void CreateDefaultAccelerationData();
     virtual void CreateAccelerationData(AccelerationTypes perObjectType);
     virtual void CreateAccelerationData(AccelerationTypes perObjectType, AccelerationTypes perMeshObjectType);
@@ -54,6 +69,7 @@ public:
     }
 
     virtual bool Trace(const SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const SceneObject* parentObject, class Ray* inputRay) const override;
 
     virtual std::string GetHumanIdentifier() const override;
     std::string GetChildObjectNames() const;
@@ -65,13 +81,16 @@ protected:
     virtual void UpdateTransformationMatrix();
     glm::mat4 worldToObjectMatrix;
     glm::mat4 objectToWorldMatrix;
+    glm::mat3 normalMatrix;
 
     glm::vec4 position;
     glm::quat rotation;
     glm::vec3 scale;
+    glm::mat4 baseTransform;
 
     class std::shared_ptr<class AccelerationStructure> acceleration;
     std::vector<std::shared_ptr<class MeshObject>> childObjects;
+    std::shared_ptr<class Material> materialOverride;
 
     bool nameSet;
     std::string objectName;
@@ -0,0 +1,129 @@
+#include "common/Scheduling/TileScheduler.h"
+
+TileScheduler::TileDeque::TileDeque():
+    top(0), bottom(0)
+{
+}
+
+void TileScheduler::TileDeque::Push(int tileIndex)
+{
+    storedTiles.push_back(tileIndex);
+    bottom.store(static_cast<int>(storedTiles.size()));
+}
+
+bool TileScheduler::TileDeque::Pop(int& tileIndex)
+{
+    const int b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b);
+    int t = top.load();
+    if (t > b) {
+        // Deque was already empty.
+        bottom.store(b + 1);
+        return false;
+    }
+
+    tileIndex = storedTiles[b];
+    if (t != b) {
+        return true;
+    }
+
+    // Last tile in the deque -- race against the thieves for it.
+    const bool won = top.compare_exchange_strong(t, t + 1);
+    bottom.store(b + 1);
+    return won;
+}
+
+bool TileScheduler::TileDeque::Steal(int& tileIndex)
+{
+    while (true) {
+        int t = top.load();
+        const int b = bottom.load();
+        if (t >= b) {
+            return false;
+        }
+
+        const int candidate = storedTiles[t];
+        if (top.compare_exchange_strong(t, t + 1)) {
+            tileIndex = candidate;
+            return true;
+        }
+    }
+}
+
+TileScheduler::TileScheduler(int rowStart, int rowEnd, int colStart, int colEnd, glm::ivec2 tileSize, int totalThreads):
+    tilesFinished(0), lastReportedPercent(0)
+{
+    assert(tileSize.x > 0 && tileSize.y > 0);
+    totalThreads = std::max(totalThreads, 1);
+
+    for (int r = rowStart; r < rowEnd; r += tileSize.y) {
+        for (int c = colStart; c < colEnd; c += tileSize.x) {
+            Tile tile;
+            tile.index = static_cast<int>(tiles.size());
+            tile.rowStart = r;
+            tile.rowEnd = std::min(r + tileSize.y, rowEnd);
+            tile.colStart = c;
+            tile.colEnd = std::min(c + tileSize.x, colEnd);
+            tiles.push_back(tile);
+        }
+    }
+
+    // Give every thread a contiguous block of tiles. Push them in reverse so that the owner works through its
+    // block in scanline order while thieves take tiles from the far end of the block.
+    const int totalTiles = static_cast<int>(tiles.size());
+    for (int i = 0; i < totalThreads; ++i) {
+        threadQueues.emplace_back(make_unique<TileDeque>());
+        threadProgress.emplace_back(make_unique<ThreadProgress>());
+
+        const int blockStart = static_cast<int>(static_cast<int64_t>(totalTiles) * i / totalThreads);
+        const int blockEnd = static_cast<int>(static_cast<int64_t>(totalTiles) * (i + 1) / totalThreads);
+        for (int t = blockEnd - 1; t >= blockStart; --t) {
+            threadQueues[i]->Push(t);
+        }
+    }
+}
+
+bool TileScheduler::NextTile(int threadIndex, Tile& output)
+{
+    assert(threadIndex >= 0 && threadIndex < GetTotalThreads());
+    int tileIndex = -1;
+    if (threadQueues[threadIndex]->Pop(tileIndex)) {
+        output = tiles[tileIndex];
+        return true;
+    }
+
+    // Nothing left locally. No new tiles are ever added, so one unsuccessful pass over all other deques means we are done.
+    const int totalThreads = GetTotalThreads();
+    for (int i = 1; i < totalThreads; ++i) {
+        const int victim = (threadIndex + i) % totalThreads;
+        if (threadQueues[victim]->Steal(tileIndex)) {
+            ++threadProgress[threadIndex]->tilesStolen;
+            output = tiles[tileIndex];
+            return true;
+        }
+    }
+    return false;
+}
+
+void TileScheduler::NotifyTileFinished(int threadIndex, const Tile& tile)
+{
+    ++threadProgress[threadIndex]->tilesRendered;
+    const int finished = ++tilesFinished;
+    const int percent = static_cast<int>(static_cast<int64_t>(finished) * 100 / GetTotalTiles());
+
+    // Only the thread that moves the counter forward gets to print.
+    int lastPercent = lastReportedPercent.load();
+    while (percent > lastPercent) {
+        if (lastReportedPercent.compare_exchange_weak(lastPercent, percent)) {
+            std::cout << percent << " % finished (" << finished << " of " << GetTotalTiles() << " tiles)..." << std::endl;
+            break;
+        }
+    }
+}
+
+void TileScheduler::PrintStatistics() const
+{
+    for (size_t i = 0; i < threadProgress.size(); ++i) {
+        std::cout << "Thread " << i << ": " << threadProgress[i]->tilesRendered << " tiles rendered, " << threadProgress[i]->tilesStolen << " stolen" << std::endl;
+    }
+}
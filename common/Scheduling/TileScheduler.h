@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/common.h"
+#include <atomic>
+
+// Splits the image into fixed-size tiles and hands them out to the render threads.
+// Every thread owns a deque of tiles; it pops work from the bottom of its own deque and,
+// once that is empty, steals from the top of another thread's deque (Chase-Lev style).
+// All tiles are pushed before rendering starts so the deques never have to grow.
+class TileScheduler
+{
+public:
+    struct Tile
+    {
+        int index;
+        int rowStart;
+        int rowEnd;
+        int colStart;
+        int colEnd;
+    };
+
+    // Covers the pixel rectangle [colStart, colEnd) x [rowStart, rowEnd).
+    TileScheduler(int rowStart, int rowEnd, int colStart, int colEnd, glm::ivec2 tileSize, int totalThreads);
+
+    // Returns false once there is no work left anywhere.
+    bool NextTile(int threadIndex, Tile& output);
+    void NotifyTileFinished(int threadIndex, const Tile& tile);
+
+    int GetTotalTiles() const { return static_cast<int>(tiles.size()); }
+    int GetTotalThreads() const { return static_cast<int>(threadQueues.size()); }
+    void PrintStatistics() const;
+
+private:
+    class TileDeque
+    {
+    public:
+        TileDeque();
+
+        // Only safe before rendering starts.
+        void Push(int tileIndex);
+
+        // Owner side.
+        bool Pop(int& tileIndex);
+        // Thief side.
+        bool Steal(int& tileIndex);
+    private:
+        std::vector<int> storedTiles;
+        std::atomic<int> top;
+        std::atomic<int> bottom;
+    };
+
+    struct ThreadProgress
+    {
+        ThreadProgress() : tilesRendered(0), tilesStolen(0) {}
+        std::atomic<int> tilesRendered;
+        std::atomic<int> tilesStolen;
+    };
+
+    std::vector<Tile> tiles;
+    std::vector<std::unique_ptr<TileDeque>> threadQueues;
+    std::vector<std::unique_ptr<ThreadProgress>> threadProgress;
+
+    std::atomic<int> tilesFinished;
+    std::atomic<int> lastReportedPercent;
+};
@@ -18,6 +18,11 @@ void Diagnostics::IncrementStat(DiagnosticsType type)
     ++statisticsAggregator[type];
 }
 
+void Diagnostics::IncrementStat(DiagnosticsType type, int amount)
+{
+    statisticsAggregator[type] += amount;
+}
+
 void Diagnostics::Log(const std::string& log)
 {
     std::cout << log << std::endl;
@@ -29,6 +34,8 @@ void Diagnostics::Print()
     std::cout << "Ray-Triangle Intersections: " << statisticsAggregator[DiagnosticsType::TRIANGLE_INTERSECTIONS] << std::endl;
     std::cout << "Ray-Box Intersections: " << statisticsAggregator[DiagnosticsType::BOX_INTERSECTIONS] << std::endl;
     std::cout << "Rays Created: " << statisticsAggregator[DiagnosticsType::RAYS_CREATED] << std::endl;
+    std::cout << "Grid Voxels Visited: " << statisticsAggregator[DiagnosticsType::GRID_VOXELS_VISITED] << std::endl;
+    std::cout << "Grid Mailbox Hits: " << statisticsAggregator[DiagnosticsType::GRID_MAILBOX_HITS] << std::endl;
     std::cout << "====================== DIAGNOSTICS END ========================" << std::endl;
 }
 
@@ -7,11 +7,14 @@ enum class DiagnosticsType
     TRIANGLE_INTERSECTIONS = 0,
     BOX_INTERSECTIONS,
     RAYS_CREATED,
+    GRID_VOXELS_VISITED,
+    GRID_MAILBOX_HITS,
     MAX
 };
 
 #if DIAGNOSTICS_ON
 #define DIAGNOSTICS_STAT(t) Diagnostics::Get()->IncrementStat(t)
+#define DIAGNOSTICS_STAT_ADD(t,n) Diagnostics::Get()->IncrementStat(t, n)
 #define DIAGNOSTICS_PRINT() Diagnostics::Get()->Print()
 #define DIAGNOSTICS_TIMER(N,D) Timer N(D)
 #define DIAGNOSTICS_END_TIMER(N) N.Tock()
@@ -28,6 +31,7 @@ public:
     static Diagnostics* Get();
 
     void IncrementStat(DiagnosticsType type);
+    void IncrementStat(DiagnosticsType type, int amount);
     void Print();
     void Log(const std::string& log);
 private:
@@ -37,6 +41,7 @@ private:
 
 #else
 #define DIAGNOSTICS_STAT(t)
+#define DIAGNOSTICS_STAT_ADD(t,n)
 #define DIAGNOSTICS_PRINT
 #define DIAGNOSTICS_TIMER(N,D)
 #define DIAGNOSTICS_END_TIMER(N)
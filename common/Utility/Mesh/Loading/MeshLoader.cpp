@@ -1,4 +1,5 @@
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Scene/SceneObject.h"
 #include "common/Utility/Mesh/Loading/MeshLoader.h"
 #include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
@@ -43,7 +44,7 @@ void LoadFaceIntoPrimitive(const aiFace& face, PrimitiveBase& primitive, std::ve
     }
 }
 
-std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials)
+std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials, std::vector<MeshInstance>* outputInstances)
 {
 
 #ifndef ASSET_PATH
@@ -80,6 +81,8 @@ std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, s
     }
 
     std::vector<std::shared_ptr<MeshObject>> loadedMeshes;
+    // Skipped meshes leave gaps, so node mesh indices have to go through this table.
+    std::vector<int> loadedMeshIndex(scene->mNumMeshes, -1);
     for (decltype(scene->mNumMeshes) i = 0; i < scene->mNumMeshes; ++i) {
         const aiMesh* mesh = scene->mMeshes[i];
         if (!mesh->HasPositions()) {
@@ -149,31 +152,76 @@ std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, s
             }
         }
 
+        loadedMeshIndex[i] = static_cast<int>(loadedMeshes.size());
         loadedMeshes.push_back(std::move(newMesh));
         if (outputMaterials) {
             outputMaterials->push_back(sceneMaterials[mesh->mMaterialIndex]);
         }
     }
 
-    // Traverse nodes to set mesh names
-    std::queue<aiNode*> nodes;
-    nodes.push(scene->mRootNode);
+    // Traverse nodes to set mesh names and collect the placement of every mesh reference.
+    std::queue<std::pair<aiNode*, glm::mat4>> nodes;
+    nodes.push(std::make_pair(scene->mRootNode, glm::mat4(1.f)));
     while (!nodes.empty()) {
-        aiNode* currentNode = nodes.front();
+        aiNode* currentNode = nodes.front().first;
+        const aiMatrix4x4& localTransform = currentNode->mTransformation;
+        // Assimp matrices are row-major, glm is column-major.
+        const glm::mat4 nodeTransform = nodes.front().second * glm::mat4(
+            localTransform.a1, localTransform.b1, localTransform.c1, localTransform.d1,
+            localTransform.a2, localTransform.b2, localTransform.c2, localTransform.d2,
+            localTransform.a3, localTransform.b3, localTransform.c3, localTransform.d3,
+            localTransform.a4, localTransform.b4, localTransform.c4, localTransform.d4);
         nodes.pop();
 
-        if (currentNode->mNumMeshes) {
-            for (unsigned int i = 0; i < currentNode->mNumMeshes; ++i) {
-                loadedMeshes[currentNode->mMeshes[i]]->SetName(currentNode->mName.C_Str());
+        for (unsigned int i = 0; i < currentNode->mNumMeshes; ++i) {
+            const int meshIndex = loadedMeshIndex[currentNode->mMeshes[i]];
+            if (meshIndex < 0) {
+                continue;
+            }
+            loadedMeshes[meshIndex]->SetName(currentNode->mName.C_Str());
+
+            if (outputInstances) {
+                MeshInstance instance;
+                instance.meshIndex = meshIndex;
+                instance.transform = nodeTransform;
+                instance.name = currentNode->mName.C_Str();
+                outputInstances->push_back(instance);
             }
         }
 
         for (unsigned int i = 0; i < currentNode->mNumChildren; ++i) {
-            nodes.push(currentNode->mChildren[i]);
+            nodes.push(std::make_pair(currentNode->mChildren[i], nodeTransform));
         }
     }
 
     return loadedMeshes;
 }
 
+std::vector<std::shared_ptr<SceneObject>> CreateInstancedObjects(const std::vector<std::shared_ptr<MeshObject>>& meshes, const std::vector<MeshInstance>& instances, AccelerationTypes perObjectType, AccelerationTypes perMeshObjectType)
+{
+    // The sources only hold the shared data; they are never added to a scene themselves.
+    std::vector<std::shared_ptr<SceneObject>> sourceObjects(meshes.size());
+    std::vector<std::shared_ptr<SceneObject>> output;
+    output.reserve(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const MeshInstance& placement = instances[i];
+        assert(placement.meshIndex >= 0 && static_cast<size_t>(placement.meshIndex) < meshes.size());
+
+        std::shared_ptr<SceneObject>& source = sourceObjects[placement.meshIndex];
+        if (!source) {
+            source = std::make_shared<SceneObject>();
+            source->AddMeshObject(meshes[placement.meshIndex]);
+            source->CreateAccelerationData(perObjectType, perMeshObjectType);
+        }
+
+        std::shared_ptr<SceneObject> instance = source->CreateInstance();
+        instance->SetBaseTransform(placement.transform);
+        if (!placement.name.empty()) {
+            instance->SetName(placement.name);
+        }
+        output.push_back(std::move(instance));
+    }
+    return output;
+}
+
 }
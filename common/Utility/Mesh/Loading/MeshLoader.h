@@ -6,6 +6,8 @@
 #include "common/common.h"
 
 class MeshObject;
+class SceneObject;
+enum class AccelerationTypes;
 struct aiMaterial;
 struct aiFace;
 class PrimitiveBase;
@@ -13,7 +15,20 @@ class PrimitiveBase;
 namespace MeshLoader
 {
 
-std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials = nullptr);
+// One placement of a loaded mesh in the node hierarchy of the file. Meshes referenced by several nodes appear once
+// per node, so they can be shared between SceneObject instances instead of being duplicated (see CreateInstancedObjects).
+struct MeshInstance
+{
+    int meshIndex;
+    glm::mat4 transform;
+    std::string name;
+};
+
+std::vector<std::shared_ptr<MeshObject>> LoadMesh(const std::string& filename, std::vector<std::shared_ptr<aiMaterial>>* outputMaterials = nullptr, std::vector<MeshInstance>* outputInstances = nullptr);
+
+// One SceneObject per placement, placed by its node transform. All placements of a mesh are instances of the same
+// object, so the mesh and its acceleration structures are only stored (and built) once.
+std::vector<std::shared_ptr<SceneObject>> CreateInstancedObjects(const std::vector<std::shared_ptr<MeshObject>>& meshes, const std::vector<MeshInstance>& instances, AccelerationTypes perObjectType, AccelerationTypes perMeshObjectType);
 
 void LoadFaceIntoPrimitive(const aiFace& face, PrimitiveBase& primitive, std::vector<glm::vec3>& allPosition, std::vector<glm::vec3>& allNormals, std::vector<glm::vec2>& allUV, std::vector<glm::vec3>& allTangents, std::vector<glm::vec3>& allBitangents);
 void LoadFaceIntoPrimitive(unsigned int numVertices, unsigned int* indices, PrimitiveBase& primitive, std::vector<glm::vec3>& allPosition, std::vector<glm::vec3>& allNormals, std::vector<glm::vec2>& allUV, std::vector<glm::vec3>& allTangents, std::vector<glm::vec3>& allBitangents);
@@ -31,6 +31,7 @@ const float SMALL_EPSILON = 1e-7f;
 #define STRINGIFY_HELPER(x) #x
 #define STRINGIFY(x) STRINGIFY_HELPER(x)
 #define DISABLE_ACCELERATION_CREATION_TIMER 1
+#define DISABLE_BVH_COST_REPORT 1
 
 
 #ifdef _WIN32
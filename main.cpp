@@ -1,4 +1,7 @@
 #include "common/RayTracer.h"
+#include "common/Application.h"
+#include <cstdlib>
+#include <cstring>
 
 #define ASSIGNMENT 9
 #if ASSIGNMENT == 5
@@ -27,6 +30,24 @@
 int main(int argc, char** argv)  
 {
     std::unique_ptr<APPLICATION> currentApplication = make_unique<APPLICATION>();
+
+    // Optional arguments:
+    //   --region <x0> <y0> <x1> <y1>  only render the pixels in [x0, x1) x [y0, y1)
+    //   --hdr <file>                  merge the render into this HDR buffer and update it afterwards
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--region") && i + 4 < argc) {
+            const glm::ivec2 minPixel(std::atoi(argv[i + 1]), std::atoi(argv[i + 2]));
+            const glm::ivec2 maxPixel(std::atoi(argv[i + 3]), std::atoi(argv[i + 4]));
+            currentApplication->SetRenderRegion(minPixel, maxPixel);
+            i += 4;
+        } else if (!std::strcmp(argv[i], "--hdr") && i + 1 < argc) {
+            currentApplication->SetHDRBufferFilename(argv[i + 1]);
+            i += 1;
+        } else {
+            std::cerr << "WARNING: Ignoring unknown argument " << argv[i] << std::endl;
+        }
+    }
+
     RayTracer rayTracer(std::move(currentApplication));
 
     DIAGNOSTICS_TIMER(timer, "Ray Tracer");
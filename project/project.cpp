@@ -1,32 +1,6 @@
 #include "project/project.h"
 #include "common/core.h"
 
-void addSphereLight(glm::vec3 center, float radius, int numPointLights, glm::vec3 lightColor, std::shared_ptr<Scene> scene){
-
-    for (int i = 0; i < numPointLights; i++){
-        // sample random uniformly on unit sphere
-        float u = (float)std::rand() / RAND_MAX * 2 - 1; //uniform in [-1, 1)
-        float theta = (float)std::rand() / RAND_MAX *2 * PI; //uniform in [0, 2*PI)
-
-
-        float x = std::sqrt(1-u*u) * std::cos(theta);
-        float y = std::sqrt(1-u*u) * std::sin(theta);
-        float z = u;
-
-        glm::vec3 lightPos(x, y, z);
-
-        // transform from unit sphere to our sphere
-        lightPos = lightPos * radius;
-        lightPos = lightPos + center;
-
-        // create point light
-        std::shared_ptr<Light> pointLight = std::make_shared<PointLight>();
-        pointLight->SetPosition(lightPos);
-        pointLight->SetLightColor(lightColor / float(numPointLights));
-        scene->AddLight(pointLight);
-    }
-}
-
 void addSoftSpotlight(glm::vec3 center, float radius, int numSpotLights, glm::vec3 lightColor, std::shared_ptr<Scene> scene,
                       float rotX, float rotY, float rotZ, float theta1, float theta2){
 
@@ -40,8 +14,8 @@ void addSoftSpotlight(glm::vec3 center, float radius, int numSpotLights, glm::ve
         spotLight->SetLightColor(lightColor / float(numSpotLights));
 
         // sample random uniformly on CIRCLE
-        float r = (float)std::rand() / RAND_MAX; //uniform in [0, 1)
-        float theta = (float)std::rand() / RAND_MAX *2 * PI; //uniform in [0, 2*PI)
+        float r = RandomSequence::NextFloat(); //uniform in [0, 1)
+        float theta = RandomSequence::NextFloat() *2 * PI; //uniform in [0, 2*PI)
 
 
         float x = std::sqrt(r) * std::cos(theta) * radius;
@@ -146,11 +120,10 @@ std::shared_ptr<Scene> project::CreateScene() const
     glm::vec3 violetColor = glm::vec3(0.3f, 0.037f, 0.855f);
 
     // add a sphere light to make shadow nicer
-    std::shared_ptr<Light> pointLight = std::make_shared<PointLight>();
-    glm::vec3 pos = glm::vec3(4.09601f, 5.2227f, 5.24693f);
-    glm::vec3 color = orangeColor * 2.f;
-    scene->AddLight(pointLight);
-    addSphereLight(pos, 0.15f, 12, color, scene);
+    std::shared_ptr<Light> orangeSphereLight = std::make_shared<SphereLight>(0.15f);
+    orangeSphereLight->SetPosition(glm::vec3(4.09601f, 5.2227f, 5.24693f));
+    orangeSphereLight->SetLightColor(orangeColor * 2.f);
+    scene->AddLight(orangeSphereLight);
 
     // add another one, maybe we can get rid of photon mapping (in piano keys corner)
     std::shared_ptr<Light> pointLight2 = std::make_shared<PointLight>();
@@ -178,16 +151,20 @@ std::shared_ptr<Scene> project::CreateScene() const
     glm::vec3 spotLightPosition = glm::vec3(-2.08115f, 2.5532f, 8.92671f);
     addSoftSpotlight(spotLightPosition, 0.0f, 1, spotLightColor, scene, rotX, rotY, rotZ, theta1, theta2);
 
-    // add the two candle lights using POINT lights
+    // add the two candle lights as sphere lights. They only spend more than one shadow ray where they look big.
     glm::vec3 candleColor = glm::vec3(1.f, 0.2f, 0.05f)*8.f;
-
-    // try adding the two sphere lights
     glm::vec3 lightPos1 = glm::vec3(4.46158f, 1.94833f, 7.22604f);
     glm::vec3 lightPos2 = glm::vec3(-1.16581f, -0.760411f, 7.22604f);
     float radius = 0.12f;
-    int numPointLights = 12;
-    addSphereLight(lightPos1, radius, numPointLights, candleColor, scene);
-    addSphereLight(lightPos2, radius, numPointLights, candleColor, scene);
+
+    std::shared_ptr<Light> sphereLight1 = std::make_shared<SphereLight>(radius);
+    std::shared_ptr<Light> sphereLight2 = std::make_shared<SphereLight>(radius);
+    sphereLight1->SetPosition(lightPos1);
+    sphereLight1->SetLightColor(candleColor);
+    scene->AddLight(sphereLight1);
+    sphereLight2->SetPosition(lightPos2);
+    sphereLight2->SetLightColor(candleColor);
+    scene->AddLight(sphereLight2);
 
     // add another SPOT light for cool reflections
     theta1 = 40.0f / 360.f * PI;
@@ -200,21 +177,6 @@ std::shared_ptr<Scene> project::CreateScene() const
     addSoftSpotlight(spotLightPosition, 0.15f, 12, spotLightColor, scene, rotX, rotY, rotZ, theta1, theta2);
 
 
-//    // try it with the real sphere light implementation
-//    glm::vec3 lightPos1 = glm::vec3(4.46158f, 1.94833f, 7.22604f);
-//    glm::vec3 lightPos2 = glm::vec3(-1.16581f, -0.760411f, 7.22604f);
-//    float radius = 0.12f;
-
-//    std::shared_ptr<Light> sphereLight1 = std::make_shared<SphereLight>(radius);
-//    std::shared_ptr<Light> sphereLight2 = std::make_shared<SphereLight>(radius);
-//    sphereLight1->SetPosition(lightPos1);
-//    sphereLight1->SetLightColor(candleColor);
-//    scene->AddLight(sphereLight1);
-//    sphereLight2->SetPosition(lightPos2);
-//    sphereLight2->SetLightColor(candleColor);
-//    scene->AddLight(sphereLight2);
-
-
     /////////////////////////////////////////////
 
     // Material
@@ -287,6 +249,9 @@ std::shared_ptr<class Renderer> project::CreateRenderer(std::shared_ptr<Scene> s
 //    std::shared_ptr<PerspectiveCamera> pcamera = std::dynamic_pointer_cast<PerspectiveCamera> (camera);
 //    renderer->setPerspectiveCamera(pcamera);
 
+    // Converged global illumination instead of the photon map; pair it with GetProgressivePasses() for long renders.
+//    std::shared_ptr<PathTracingRenderer> renderer = std::make_shared<PathTracingRenderer>(scene, sampler);
+
     return renderer;
 }
 